@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    ChainSettings.cpp
+
+  ==============================================================================
+*/
+
+#include "ChainSettings.h"
+
+// implementing chainsetting grab
+
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& parameterManager)
+{
+    ChainSettings settings;
+
+    settings.lowCutFreq = parameterManager.getRawParameterValue("LowCut Freq")->load();
+    settings.highCutFreq = parameterManager.getRawParameterValue("HiCut Freq")->load();
+    settings.peakFreq = parameterManager.getRawParameterValue("Peak Freq")->load();
+    settings.peakGainInDecibels = parameterManager.getRawParameterValue("Peak Gain")->load();
+    settings.peakQuality = parameterManager.getRawParameterValue("Quality")->load();
+    settings.lowCutSlope = static_cast<Slope>(parameterManager.getRawParameterValue("LowCut Slope")->load());
+    settings.highCutSlope = static_cast<Slope>(parameterManager.getRawParameterValue("HiCut Slope")->load());
+    return settings; 
+}
+
+void setChainSettings(juce::AudioProcessorValueTreeState& parameterManager, const ChainSettings& settings)
+{
+    auto set = [&parameterManager](const char* parameterID, float value)
+    {
+        if (auto* parameter = parameterManager.getParameter(parameterID))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    };
+
+    set("LowCut Freq", settings.lowCutFreq);
+    set("HiCut Freq", settings.highCutFreq);
+    set("Peak Freq", settings.peakFreq);
+    set("Peak Gain", settings.peakGainInDecibels);
+    set("Quality", settings.peakQuality);
+    set("LowCut Slope", (float) settings.lowCutSlope);
+    set("HiCut Slope", (float) settings.highCutSlope);
+}
+
+ChainSettings getLegalChainSettings(juce::AudioProcessorValueTreeState& parameterManager, const ChainSettings& settings)
+{
+    auto snap = [&parameterManager](const char* parameterID, float value)
+    {
+        if (auto* parameter = parameterManager.getParameter(parameterID))
+            return parameter->convertFrom0to1(parameter->convertTo0to1(value));
+
+        return value;
+    };
+
+    ChainSettings legalSettings;
+
+    legalSettings.lowCutFreq = snap("LowCut Freq", settings.lowCutFreq);
+    legalSettings.highCutFreq = snap("HiCut Freq", settings.highCutFreq);
+    legalSettings.peakFreq = snap("Peak Freq", settings.peakFreq);
+    legalSettings.peakGainInDecibels = snap("Peak Gain", settings.peakGainInDecibels);
+    legalSettings.peakQuality = snap("Quality", settings.peakQuality);
+    legalSettings.lowCutSlope = static_cast<Slope>(juce::roundToInt(snap("LowCut Slope", (float) settings.lowCutSlope)));
+    legalSettings.highCutSlope = static_cast<Slope>(juce::roundToInt(snap("HiCut Slope", (float) settings.highCutSlope)));
+    return legalSettings;
+}
+
+ChainParameters getChainParameters(juce::AudioProcessorValueTreeState& parameterManager)
+{
+    ChainParameters parameters;
+
+    parameters.lowCutFreq = parameterManager.getRawParameterValue("LowCut Freq");
+    parameters.highCutFreq = parameterManager.getRawParameterValue("HiCut Freq");
+    parameters.peakFreq = parameterManager.getRawParameterValue("Peak Freq");
+    parameters.peakGainInDecibels = parameterManager.getRawParameterValue("Peak Gain");
+    parameters.peakQuality = parameterManager.getRawParameterValue("Quality");
+    parameters.lowCutSlope = parameterManager.getRawParameterValue("LowCut Slope");
+    parameters.highCutSlope = parameterManager.getRawParameterValue("HiCut Slope");
+
+    jassert(parameters.lowCutFreq != nullptr && parameters.highCutFreq != nullptr && parameters.peakFreq != nullptr
+        && parameters.peakGainInDecibels != nullptr && parameters.peakQuality != nullptr
+        && parameters.lowCutSlope != nullptr && parameters.highCutSlope != nullptr);
+    return parameters;
+}
+
+ChainSettings getChainSettings(const ChainParameters& parameters)
+{
+    ChainSettings settings;
+
+    settings.lowCutFreq = parameters.lowCutFreq->load();
+    settings.highCutFreq = parameters.highCutFreq->load();
+    settings.peakFreq = parameters.peakFreq->load();
+    settings.peakGainInDecibels = parameters.peakGainInDecibels->load();
+    settings.peakQuality = parameters.peakQuality->load();
+    settings.lowCutSlope = static_cast<Slope>(parameters.lowCutSlope->load());
+    settings.highCutSlope = static_cast<Slope>(parameters.highCutSlope->load());
+    return settings;
+}
+
+int getChangedBands(const ChainSettings& oldSettings, const ChainSettings& newSettings)
+{
+    int changedBands = 0;
+
+    if (oldSettings.lowCutFreq != newSettings.lowCutFreq || oldSettings.lowCutSlope != newSettings.lowCutSlope)
+        changedBands |= LOW_CUT_BAND;
+
+    if (oldSettings.peakFreq != newSettings.peakFreq || oldSettings.peakGainInDecibels != newSettings.peakGainInDecibels
+        || oldSettings.peakQuality != newSettings.peakQuality)
+        changedBands |= PEAK_BAND;
+
+    if (oldSettings.highCutFreq != newSettings.highCutFreq || oldSettings.highCutSlope != newSettings.highCutSlope)
+        changedBands |= HIGH_CUT_BAND;
+
+    return changedBands;
+}
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    ChainSettings.h
+    Plain parameter snapshot of the EQ chain, shared by the processor and
+    the coefficient designer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+
+// We save temp parameters as a struct so its easy to access
+enum Slope
+{
+    SLOPE_12,
+    SLOPE_24,
+    SLOPE_36,
+    SLOPE_48
+};
+
+struct ChainSettings
+{
+    float peakFreq{ 0 }, peakGainInDecibels{ 0 }, peakQuality{ 1.f };
+    float lowCutFreq{ 0 }, highCutFreq{ 0 };
+    Slope lowCutSlope{ Slope::SLOPE_12 }, highCutSlope{ Slope::SLOPE_12 };
+
+};
+
+
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& parameterManager);
+
+// Writes settings into the parameters, notifying the host
+void setChainSettings(juce::AudioProcessorValueTreeState& parameterManager, const ChainSettings& settings);
+
+// The settings as the parameters would hold them once set, i.e. limited and snapped to each parameter's range
+ChainSettings getLegalChainSettings(juce::AudioProcessorValueTreeState& parameterManager, const ChainSettings& settings);
+
+// Raw parameter pointers, resolved once so the audio thread never does string lookups
+struct ChainParameters
+{
+    std::atomic<float>* lowCutFreq{ nullptr };
+    std::atomic<float>* highCutFreq{ nullptr };
+    std::atomic<float>* peakFreq{ nullptr };
+    std::atomic<float>* peakGainInDecibels{ nullptr };
+    std::atomic<float>* peakQuality{ nullptr };
+    std::atomic<float>* lowCutSlope{ nullptr };
+    std::atomic<float>* highCutSlope{ nullptr };
+};
+
+ChainParameters getChainParameters(juce::AudioProcessorValueTreeState& parameterManager);
+ChainSettings getChainSettings(const ChainParameters& parameters);
+
+// One bit per band, set when that band's settings moved and its coefficients need redesigning
+enum BandMask
+{
+    LOW_CUT_BAND = 1 << 0,
+    PEAK_BAND = 1 << 1,
+    HIGH_CUT_BAND = 1 << 2,
+    ALL_BANDS = LOW_CUT_BAND | PEAK_BAND | HIGH_CUT_BAND
+};
+
+int getChangedBands(const ChainSettings& oldSettings, const ChainSettings& newSettings);
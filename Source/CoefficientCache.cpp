@@ -0,0 +1,209 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.cpp
+
+  ==============================================================================
+*/
+
+#include "CoefficientCache.h"
+
+//==============================================================================
+bool CoefficientCache::Key::operator==(const Key& other) const noexcept
+{
+    return designRate == other.designRate && frequency == other.frequency && quality == other.quality
+        && gainInDecibels == other.gainInDecibels && band == other.band && slope == other.slope;
+}
+
+CoefficientCache& CoefficientCache::getInstance()
+{
+    // plain static storage, so the table costs no heap and is there before the first instance needs it
+    static CoefficientCache instance;
+    return instance;
+}
+
+CoefficientCache::Key CoefficientCache::makeKey(BandMask band, double designRate, const ChainSettings& chainSettings) noexcept
+{
+    Key key;
+    key.designRate = designRate;
+    key.band = (int) band;
+
+    if (band == PEAK_BAND)
+    {
+        key.frequency = chainSettings.peakFreq;
+        key.quality = chainSettings.peakQuality;
+        key.gainInDecibels = chainSettings.peakGainInDecibels;
+    }
+    else if (band == LOW_CUT_BAND)
+    {
+        key.frequency = chainSettings.lowCutFreq;
+        key.slope = (int) chainSettings.lowCutSlope;
+    }
+    else
+    {
+        key.frequency = chainSettings.highCutFreq;
+        key.slope = (int) chainSettings.highCutSlope;
+    }
+
+    return key;
+}
+
+juce::uint32 CoefficientCache::getSetIndex(const Key& key) noexcept
+{
+    juce::uint64 rateBits;
+    std::memcpy(&rateBits, &key.designRate, sizeof(rateBits));
+
+    auto hash = rateBits;
+
+    for (auto value : { key.frequency, key.quality, key.gainInDecibels })
+    {
+        juce::uint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        hash = (hash ^ bits) * 0x9e3779b97f4a7c15ull;
+    }
+
+    hash = (hash ^ (juce::uint64) (key.band * 8 + key.slope)) * 0x9e3779b97f4a7c15ull;
+    return (juce::uint32) (hash >> 32) % (juce::uint32) numSets;
+}
+
+template <typename Type>
+Type CoefficientCache::load(const Words<Type>& words) noexcept
+{
+    juce::uint64 buffer[std::tuple_size<Words<Type>>::value];
+
+    for (size_t i = 0; i < words.size(); ++i)
+        buffer[i] = words[i].load(std::memory_order_relaxed);
+
+    Type value;
+    std::memcpy(&value, buffer, sizeof(Type));
+    return value;
+}
+
+template <typename Type>
+void CoefficientCache::store(Words<Type>& words, const Type& value) noexcept
+{
+    juce::uint64 buffer[std::tuple_size<Words<Type>>::value] = {};
+    std::memcpy(buffer, &value, sizeof(Type));
+
+    for (size_t i = 0; i < words.size(); ++i)
+        words[i].store(buffer[i], std::memory_order_relaxed);
+}
+
+//==============================================================================
+bool CoefficientCache::lookup(const Key& key, BandDesign& design) noexcept
+{
+    const auto setIndex = getSetIndex(key);
+    auto* set = slots.data() + (size_t) setIndex * numWays;
+
+    for (int way = 0; way < numWays; ++way)
+    {
+        auto& slot = set[way];
+        const auto sequence = slot.sequence.load(std::memory_order_acquire);
+
+        if ((sequence & 1) != 0 || !(load<Key>(slot.key) == key))
+            continue;
+
+        const auto copy = load<BandDesign>(slot.design);
+
+        // a writer that got in while we were copying leaves a different sequence behind
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+            continue;
+
+        design = copy;
+
+        // most hits find the stamp already current and write nothing
+        const auto now = setClocks[setIndex].load(std::memory_order_relaxed);
+
+        if (slot.lastUsed.load(std::memory_order_relaxed) != now)
+            slot.lastUsed.store(now, std::memory_order_relaxed);
+
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void CoefficientCache::insert(const Key& key, const BandDesign& design) noexcept
+{
+    const auto setIndex = getSetIndex(key);
+    auto* set = slots.data() + (size_t) setIndex * numWays;
+    Slot* victim = nullptr;
+    auto victimIsEmpty = false;
+
+    for (int way = 0; way < numWays; ++way)
+    {
+        auto& slot = set[way];
+        const auto slotKey = load<Key>(slot.key);
+
+        // another thread designed the same band first
+        if (slotKey == key)
+            return;
+
+        const auto isEmpty = slotKey.designRate == 0;
+
+        if (victim == nullptr || (isEmpty && !victimIsEmpty)
+            || (!victimIsEmpty && slot.lastUsed.load(std::memory_order_relaxed) < victim->lastUsed.load(std::memory_order_relaxed)))
+        {
+            victim = &slot;
+            victimIsEmpty = isEmpty;
+        }
+    }
+
+    auto sequence = victim->sequence.load(std::memory_order_relaxed);
+
+    // somebody else is writing this slot, it's only a cache so this design just isn't kept
+    if ((sequence & 1) != 0 || !victim->sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire))
+        return;
+
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const auto wasEmpty = load<Key>(victim->key).designRate == 0;
+    store(victim->key, key);
+    store(victim->design, design);
+    victim->sequence.store(sequence + 2, std::memory_order_release);
+    victim->lastUsed.store(setClocks[setIndex].fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    insertions.fetch_add(1, std::memory_order_relaxed);
+
+    if (!wasEmpty)
+        evictions.fetch_add(1, std::memory_order_relaxed);
+}
+
+CoefficientCache::Statistics CoefficientCache::getStatistics() const noexcept
+{
+    Statistics statistics;
+    statistics.hits = hits.load(std::memory_order_relaxed);
+    statistics.misses = misses.load(std::memory_order_relaxed);
+    statistics.insertions = insertions.load(std::memory_order_relaxed);
+    statistics.evictions = evictions.load(std::memory_order_relaxed);
+    statistics.capacity = capacity;
+
+    for (auto& slot : slots)
+        if (load<Key>(slot.key).designRate != 0)
+            ++statistics.numEntries;
+
+    return statistics;
+}
+
+void CoefficientCache::clear() noexcept
+{
+    for (auto& slot : slots)
+    {
+        auto sequence = slot.sequence.load(std::memory_order_relaxed);
+
+        if ((sequence & 1) != 0 || !slot.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire))
+            continue;
+
+        std::atomic_thread_fence(std::memory_order_release);
+        store(slot.key, Key{});
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+        slot.lastUsed.store(0, std::memory_order_relaxed);
+    }
+
+    for (auto* counter : { &hits, &misses, &insertions, &evictions })
+        counter->store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.h
+    Process-wide cache of designed bands, shared by every instance. A session
+    full of EQs with the same low cut only designs it once.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "CoefficientDesigner.h"
+
+
+//==============================================================================
+/**
+    Keyed on (design rate, band, frequency, Q, gain, slope). The parameters are
+    quantised, so settings that came from them repeat exactly and the key can
+    compare float values exactly.
+
+    A fixed table of 4-way sets with approximately least-recently-used
+    eviction, so the memory never grows. Every slot is a seqlock over atomic
+    words: a reader that overlaps a writer never retries, it just counts a
+    miss, and writers claim a slot with one compare-and-swap and give up if
+    another thread holds it. Nothing blocks and nothing allocates, so it's safe
+    from any thread.
+
+    Each set keeps its own clock, which only ticks on insertions. A hit stamps
+    its slot with the set's current time, and only writes when the stamp is
+    out of date, so hits from many threads don't fight over one counter.
+*/
+class CoefficientCache
+{
+public:
+    // Everything one band designs into a CoefficientSet, in both topologies. The peak uses stage 0, and stage 1 for its dynamic band pass.
+    struct BandDesign
+    {
+        CoefficientSet::CutStages stages;
+        CoefficientSet::SVFCutStages svfStages;
+        int numStages{ 0 };
+    };
+
+    struct Key
+    {
+        double designRate{ 0 };
+        float frequency{ 0 }, quality{ 0 }, gainInDecibels{ 0 };
+        int band{ 0 }, slope{ 0 };
+
+        bool operator==(const Key& other) const noexcept;
+    };
+
+    struct Statistics
+    {
+        juce::uint64 hits{ 0 }, misses{ 0 }, insertions{ 0 }, evictions{ 0 };
+        int numEntries{ 0 }, capacity{ 0 };
+
+        double getHitRate() const noexcept { return hits + misses > 0 ? (double) hits / (double) (hits + misses) : 0.0; }
+    };
+
+    static constexpr int numWays = 4, numSets = 512, capacity = numWays * numSets;
+
+    CoefficientCache() = default;
+
+    // The one instance for the whole process
+    static CoefficientCache& getInstance();
+
+    // Only the settings that band depends on go into the key
+    static Key makeKey(BandMask band, double designRate, const ChainSettings& chainSettings) noexcept;
+
+    // Returns false on a miss, leaving design untouched
+    bool lookup(const Key& key, BandDesign& design) noexcept;
+    void insert(const Key& key, const BandDesign& design) noexcept;
+
+    Statistics getStatistics() const noexcept;
+
+    // Empties the table and zeroes the statistics. Entries being written at the same time may survive.
+    void clear() noexcept;
+
+private:
+    static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<BandDesign>::value,
+                  "slots copy keys and designs through atomic words");
+
+    template <typename Type>
+    using Words = std::array<std::atomic<juce::uint64>, (sizeof(Type) + sizeof(juce::uint64) - 1) / sizeof(juce::uint64)>;
+
+    struct Slot
+    {
+        std::atomic<juce::uint32> sequence{ 0 };    // odd while a writer owns the slot
+        std::atomic<juce::uint32> lastUsed{ 0 };    // the set's clock when the slot was last inserted or hit
+        Words<Key> key{};                           // a zero designRate marks an empty slot
+        Words<BandDesign> design{};
+    };
+
+    // Relaxed word by word, a torn copy is caught by the sequence check around it
+    template <typename Type>
+    static Type load(const Words<Type>& words) noexcept;
+
+    template <typename Type>
+    static void store(Words<Type>& words, const Type& value) noexcept;
+
+    static juce::uint32 getSetIndex(const Key& key) noexcept;
+
+    std::array<Slot, (size_t) capacity> slots;
+    std::array<std::atomic<juce::uint32>, (size_t) numSets> setClocks{};
+    std::atomic<juce::uint64> hits{ 0 }, misses{ 0 }, insertions{ 0 }, evictions{ 0 };
+
+    // lives until the process exits, so no leak detector
+    JUCE_DECLARE_NON_COPYABLE(CoefficientCache)
+};
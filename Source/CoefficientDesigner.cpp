@@ -0,0 +1,491 @@
+/*
+  ==============================================================================
+
+    CoefficientDesigner.cpp
+
+  ==============================================================================
+*/
+
+#include "CoefficientDesigner.h"
+#include "CoefficientCache.h"
+
+//==============================================================================
+// Keeps every design clear of DC and of Nyquist at the rate it's designed for. Past Nyquist the bilinear
+// prewarp folds over and the poles leave the unit circle, which a 20 kHz high cut at 22.05 or 32 kHz would do.
+static double getDesignFrequency(double sampleRate, float frequency) noexcept
+{
+    return juce::jlimit(2.0, sampleRate * 0.49, (double) frequency);
+}
+
+// Same formulas as juce::dsp::IIR::Coefficients, but computed into plain structs so nothing is allocated
+BiquadCoefficients makePeakCoefficients(double sampleRate, float frequency, float quality, float gainInDecibels)
+{
+    const auto A = std::sqrt(juce::jmax(0.0, (double) juce::Decibels::decibelsToGain(gainInDecibels)));
+    const auto omega = (juce::MathConstants<double>::twoPi * getDesignFrequency(sampleRate, frequency)) / sampleRate;
+    const auto alpha = std::sin(omega) / (2.0 * quality);
+    const auto c2 = -2.0 * std::cos(omega);
+    const auto alphaTimesA = alpha * A;
+    const auto alphaOverA = alpha / A;
+    const auto a0 = 1.0 + alphaOverA;
+
+    return { (float) ((1.0 + alphaTimesA) / a0), (float) (c2 / a0), (float) ((1.0 - alphaTimesA) / a0),
+             (float) (c2 / a0), (float) ((1.0 - alphaOverA) / a0) };
+}
+
+BiquadCoefficients makeHighPassCoefficients(double sampleRate, float frequency, double quality)
+{
+    const auto n = std::tan(juce::MathConstants<double>::pi * getDesignFrequency(sampleRate, frequency) / sampleRate);
+    const auto nSquared = n * n;
+    const auto invQ = 1.0 / quality;
+    const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+    return { (float) c1, (float) (c1 * -2.0), (float) c1,
+             (float) (c1 * 2.0 * (nSquared - 1.0)), (float) (c1 * (1.0 - invQ * n + nSquared)) };
+}
+
+BiquadCoefficients makeLowPassCoefficients(double sampleRate, float frequency, double quality)
+{
+    const auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * getDesignFrequency(sampleRate, frequency) / sampleRate);
+    const auto nSquared = n * n;
+    const auto invQ = 1.0 / quality;
+    const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+    return { (float) c1, (float) (c1 * 2.0), (float) c1,
+             (float) (c1 * 2.0 * (1.0 - nSquared)), (float) (c1 * (1.0 - invQ * n + nSquared)) };
+}
+
+// constant 0 dB peak gain, so adding gain - 1 times its output to the input gives a bell of that gain
+BiquadCoefficients makeBandPassCoefficients(double sampleRate, float frequency, float quality)
+{
+    const auto omega = (juce::MathConstants<double>::twoPi * getDesignFrequency(sampleRate, frequency)) / sampleRate;
+    const auto alpha = std::sin(omega) / (2.0 * quality);
+    const auto a0 = 1.0 + alpha;
+
+    return { (float) (alpha / a0), 0.0f, (float) (-alpha / a0),
+             (float) (-2.0 * std::cos(omega) / a0), (float) ((1.0 - alpha) / a0) };
+}
+
+BiquadCoefficients makeLowShelfCoefficients(double sampleRate, float frequency, float quality, float gainInDecibels)
+{
+    const auto A = std::sqrt(juce::jmax(0.0, (double) juce::Decibels::decibelsToGain(gainInDecibels)));
+    const auto omega = (juce::MathConstants<double>::twoPi * getDesignFrequency(sampleRate, frequency)) / sampleRate;
+    const auto cosOmega = std::cos(omega);
+    const auto beta = std::sin(omega) * std::sqrt(A) / quality;
+    const auto aMinus1TimesCos = (A - 1.0) * cosOmega;
+    const auto a0 = (A + 1.0) + aMinus1TimesCos + beta;
+
+    return { (float) (A * ((A + 1.0) - aMinus1TimesCos + beta) / a0), (float) (A * 2.0 * ((A - 1.0) - (A + 1.0) * cosOmega) / a0),
+             (float) (A * ((A + 1.0) - aMinus1TimesCos - beta) / a0),
+             (float) (-2.0 * ((A - 1.0) + (A + 1.0) * cosOmega) / a0), (float) (((A + 1.0) + aMinus1TimesCos - beta) / a0) };
+}
+
+BiquadCoefficients makeHighShelfCoefficients(double sampleRate, float frequency, float quality, float gainInDecibels)
+{
+    const auto A = std::sqrt(juce::jmax(0.0, (double) juce::Decibels::decibelsToGain(gainInDecibels)));
+    const auto omega = (juce::MathConstants<double>::twoPi * getDesignFrequency(sampleRate, frequency)) / sampleRate;
+    const auto cosOmega = std::cos(omega);
+    const auto beta = std::sin(omega) * std::sqrt(A) / quality;
+    const auto aMinus1TimesCos = (A - 1.0) * cosOmega;
+    const auto a0 = (A + 1.0) - aMinus1TimesCos + beta;
+
+    return { (float) (A * ((A + 1.0) + aMinus1TimesCos + beta) / a0), (float) (A * -2.0 * ((A - 1.0) + (A + 1.0) * cosOmega) / a0),
+             (float) (A * ((A + 1.0) + aMinus1TimesCos - beta) / a0),
+             (float) (2.0 * ((A - 1.0) - (A + 1.0) * cosOmega) / a0), (float) (((A + 1.0) - aMinus1TimesCos - beta) / a0) };
+}
+
+BiquadCoefficients makeNotchCoefficients(double sampleRate, float frequency, float quality)
+{
+    const auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * getDesignFrequency(sampleRate, frequency) / sampleRate);
+    const auto nSquared = n * n;
+    const auto invQ = 1.0 / quality;
+    const auto c1 = 1.0 / (1.0 + n * invQ + nSquared);
+
+    return { (float) (c1 * (1.0 + nSquared)), (float) (2.0 * c1 * (1.0 - nSquared)), (float) (c1 * (1.0 + nSquared)),
+             (float) (2.0 * c1 * (1.0 - nSquared)), (float) (c1 * (1.0 - n * invQ + nSquared)) };
+}
+
+// g is the prewarped cutoff, k the damping (1 / Q). Same analog prototypes and bilinear transform as above.
+static SVFCoefficients makeSVFCoefficients(double g, double k, double m0, double m1, double m2)
+{
+    const auto a1 = 1.0 / (1.0 + g * (g + k));
+    const auto a2 = g * a1;
+    const auto a3 = g * a2;
+
+    return { (float) a1, (float) a2, (float) a3, (float) m0, (float) m1, (float) m2 };
+}
+
+SVFCoefficients makePeakSVFCoefficients(double sampleRate, float frequency, float quality, float gainInDecibels)
+{
+    const auto A = std::sqrt(juce::jmax(0.0, (double) juce::Decibels::decibelsToGain(gainInDecibels)));
+    const auto g = std::tan(juce::MathConstants<double>::pi * getDesignFrequency(sampleRate, frequency) / sampleRate);
+    const auto k = 1.0 / (quality * A);
+
+    return makeSVFCoefficients(g, k, 1.0, k * (A * A - 1.0), 0.0);
+}
+
+SVFCoefficients makeHighPassSVFCoefficients(double sampleRate, float frequency, double quality)
+{
+    const auto g = std::tan(juce::MathConstants<double>::pi * getDesignFrequency(sampleRate, frequency) / sampleRate);
+    const auto k = 1.0 / quality;
+
+    return makeSVFCoefficients(g, k, 1.0, -k, -1.0);
+}
+
+SVFCoefficients makeLowPassSVFCoefficients(double sampleRate, float frequency, double quality)
+{
+    const auto g = std::tan(juce::MathConstants<double>::pi * getDesignFrequency(sampleRate, frequency) / sampleRate);
+
+    return makeSVFCoefficients(g, 1.0 / quality, 0.0, 0.0, 1.0);
+}
+
+SVFCoefficients makeBandPassSVFCoefficients(double sampleRate, float frequency, float quality)
+{
+    const auto g = std::tan(juce::MathConstants<double>::pi * getDesignFrequency(sampleRate, frequency) / sampleRate);
+    const auto k = 1.0 / quality;
+
+    return makeSVFCoefficients(g, k, 0.0, k, 0.0);
+}
+
+// Q of each second order section in an even order Butterworth cascade
+static double getButterworthQuality(int stage, int order)
+{
+    return 1.0 / (2.0 * std::cos((2.0 * stage + 1.0) * juce::MathConstants<double>::pi / (order * 2.0)));
+}
+
+int makeLowCutCoefficients(CoefficientSet::CutStages& stages, double sampleRate, float frequency, Slope slope)
+{
+    const auto numStages = (int) slope + 1;
+    const auto order = numStages * 2;
+
+    for (int i = 0; i < numStages; ++i)
+        stages[(size_t) i] = makeHighPassCoefficients(sampleRate, frequency, getButterworthQuality(i, order));
+
+    return numStages;
+}
+
+int makeHighCutCoefficients(CoefficientSet::CutStages& stages, double sampleRate, float frequency, Slope slope)
+{
+    const auto numStages = (int) slope + 1;
+    const auto order = numStages * 2;
+
+    for (int i = 0; i < numStages; ++i)
+        stages[(size_t) i] = makeLowPassCoefficients(sampleRate, frequency, getButterworthQuality(i, order));
+
+    return numStages;
+}
+
+void makeLowCutSVFCoefficients(CoefficientSet::SVFCutStages& stages, double sampleRate, float frequency, Slope slope)
+{
+    const auto numStages = (int) slope + 1;
+    const auto order = numStages * 2;
+
+    for (int i = 0; i < numStages; ++i)
+        stages[(size_t) i] = makeHighPassSVFCoefficients(sampleRate, frequency, getButterworthQuality(i, order));
+}
+
+void makeHighCutSVFCoefficients(CoefficientSet::SVFCutStages& stages, double sampleRate, float frequency, Slope slope)
+{
+    const auto numStages = (int) slope + 1;
+    const auto order = numStages * 2;
+
+    for (int i = 0; i < numStages; ++i)
+        stages[(size_t) i] = makeLowPassSVFCoefficients(sampleRate, frequency, getButterworthQuality(i, order));
+}
+
+static CoefficientCache::BandDesign makeBandDesign(BandMask band, double designRate, const ChainSettings& chainSettings)
+{
+    CoefficientCache::BandDesign design;
+
+    // both topologies are designed every time, so either engine can run from any set.
+    // The peak's dynamic mode band pass rides along in stage 1.
+    if (band == PEAK_BAND)
+    {
+        design.stages[0] = makePeakCoefficients(designRate, chainSettings.peakFreq, chainSettings.peakQuality, chainSettings.peakGainInDecibels);
+        design.svfStages[0] = makePeakSVFCoefficients(designRate, chainSettings.peakFreq, chainSettings.peakQuality, chainSettings.peakGainInDecibels);
+        design.stages[1] = makeBandPassCoefficients(designRate, chainSettings.peakFreq, chainSettings.peakQuality);
+        design.svfStages[1] = makeBandPassSVFCoefficients(designRate, chainSettings.peakFreq, chainSettings.peakQuality);
+        design.numStages = 1;
+    }
+    else if (band == LOW_CUT_BAND)
+    {
+        design.numStages = makeLowCutCoefficients(design.stages, designRate, chainSettings.lowCutFreq, chainSettings.lowCutSlope);
+        makeLowCutSVFCoefficients(design.svfStages, designRate, chainSettings.lowCutFreq, chainSettings.lowCutSlope);
+    }
+    else
+    {
+        design.numStages = makeHighCutCoefficients(design.stages, designRate, chainSettings.highCutFreq, chainSettings.highCutSlope);
+        makeHighCutSVFCoefficients(design.svfStages, designRate, chainSettings.highCutFreq, chainSettings.highCutSlope);
+    }
+
+    return design;
+}
+
+static CoefficientCache::BandDesign getBandDesign(BandMask band, double designRate, const ChainSettings& chainSettings, bool useSharedCache)
+{
+    if (!useSharedCache)
+        return makeBandDesign(band, designRate, chainSettings);
+
+    auto& cache = CoefficientCache::getInstance();
+    const auto key = CoefficientCache::makeKey(band, designRate, chainSettings);
+
+    CoefficientCache::BandDesign design;
+
+    if (!cache.lookup(key, design))
+    {
+        design = makeBandDesign(band, designRate, chainSettings);
+        cache.insert(key, design);
+    }
+
+    return design;
+}
+
+void designCoefficients(CoefficientSet& set, const ChainSettings& chainSettings, double sampleRate, int changedBands,
+                        int oversamplingFactor, bool useSharedCache)
+{
+    if (set.sampleRate != sampleRate || set.oversamplingFactor != oversamplingFactor)
+    {
+        set.sampleRate = sampleRate;
+        set.oversamplingFactor = oversamplingFactor;
+        changedBands = ALL_BANDS;
+    }
+
+    const auto oversampledRate = sampleRate * oversamplingFactor;
+
+    if (changedBands & PEAK_BAND)
+    {
+        const auto design = getBandDesign(PEAK_BAND, oversampledRate, chainSettings, useSharedCache);
+        set.peak = design.stages[0];
+        set.peakSVF = design.svfStages[0];
+        set.peakBandPass = design.stages[1];
+        set.peakBandPassSVF = design.svfStages[1];
+
+        // the detector always runs at the base rate
+        set.detectorBandPass = oversamplingFactor > 1 ? makeBandPassCoefficients(sampleRate, chainSettings.peakFreq, chainSettings.peakQuality)
+                                                      : set.peakBandPass;
+    }
+
+    if (changedBands & LOW_CUT_BAND)
+    {
+        const auto design = getBandDesign(LOW_CUT_BAND, sampleRate, chainSettings, useSharedCache);
+        set.lowCut = design.stages;
+        set.lowCutSVF = design.svfStages;
+        set.numLowCutStages = design.numStages;
+    }
+
+    if (changedBands & HIGH_CUT_BAND)
+    {
+        const auto design = getBandDesign(HIGH_CUT_BAND, oversampledRate, chainSettings, useSharedCache);
+        set.highCut = design.stages;
+        set.highCutSVF = design.svfStages;
+        set.numHighCutStages = design.numStages;
+    }
+}
+
+double getMagnitudeForFrequency(const BiquadCoefficients& coefficients, double frequency, double sampleRate) noexcept
+{
+    const auto z = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate);
+
+    const auto numerator = (double) coefficients.b0 + z * ((double) coefficients.b1 + z * (double) coefficients.b2);
+    const auto denominator = 1.0 + z * ((double) coefficients.a1 + z * (double) coefficients.a2);
+
+    return std::abs(numerator) / std::abs(denominator);
+}
+
+double getMagnitudeForFrequency(const CoefficientSet& set, double frequency) noexcept
+{
+    const auto oversampledRate = set.sampleRate * set.oversamplingFactor;
+    auto magnitude = getMagnitudeForFrequency(set.peak, frequency, oversampledRate);
+
+    for (int i = 0; i < set.numLowCutStages; ++i)
+        magnitude *= getMagnitudeForFrequency(set.lowCut[(size_t) i], frequency, set.sampleRate);
+
+    for (int i = 0; i < set.numHighCutStages; ++i)
+        magnitude *= getMagnitudeForFrequency(set.highCut[(size_t) i], frequency, oversampledRate);
+
+    return magnitude;
+}
+
+namespace
+{
+// largest pole radius of 1 + a1 z^-1 + a2 z^-2
+double getPoleRadius(const BiquadCoefficients& coefficients) noexcept
+{
+    const auto a1 = (double) coefficients.a1, a2 = (double) coefficients.a2;
+    const auto discriminant = a1 * a1 - 4.0 * a2;
+
+    if (discriminant < 0.0)
+        return std::sqrt(a2);
+
+    const auto root = std::sqrt(discriminant);
+    return juce::jmax(std::abs(-a1 + root), std::abs(-a1 - root)) * 0.5;
+}
+
+double getSlowestDecaySeconds(const BiquadCoefficients* stages, int numStages, double sampleRate, double threshold) noexcept
+{
+    auto radius = 0.0;
+
+    for (int i = 0; i < numStages; ++i)
+    {
+        const auto& stage = stages[i];
+
+        // poles cancelled by identical zeros (a 0 dB peak) don't ring
+        if (stage.b0 == 1.0f && stage.b1 == stage.a1 && stage.b2 == stage.a2)
+            continue;
+
+        radius = juce::jmax(radius, getPoleRadius(stage));
+    }
+
+    // all zero poles (or an identity stage) decay straight away, a pole on the unit circle never does
+    if (radius <= 0.0)
+        return 0.0;
+
+    radius = juce::jmin(radius, 1.0 - 1.0e-9);
+    return std::log(threshold) / std::log(radius) / sampleRate;
+}
+}
+
+double getDecayTimeSeconds(const CoefficientSet& set, double thresholdDecibels, bool includeDynamicBand) noexcept
+{
+    if (set.sampleRate <= 0)
+        return 0.0;
+
+    const auto threshold = juce::Decibels::decibelsToGain(thresholdDecibels, -300.0);
+    const auto oversampledRate = set.sampleRate * set.oversamplingFactor;
+
+    return getSlowestDecaySeconds(set.lowCut.data(), set.numLowCutStages, set.sampleRate, threshold)
+         + getSlowestDecaySeconds(&set.peak, 1, oversampledRate, threshold)
+         + getSlowestDecaySeconds(set.highCut.data(), set.numHighCutStages, oversampledRate, threshold)
+         + (includeDynamicBand ? getSlowestDecaySeconds(&set.peakBandPass, 1, oversampledRate, threshold) : 0.0);
+}
+
+double getDecayTimeSeconds(const BiquadCoefficients* stages, int numStages, double sampleRate, double thresholdDecibels) noexcept
+{
+    if (sampleRate <= 0)
+        return 0.0;
+
+    return getSlowestDecaySeconds(stages, numStages, sampleRate, juce::Decibels::decibelsToGain(thresholdDecibels, -300.0));
+}
+
+//==============================================================================
+DesignerThread::DesignerThread() : juce::Thread("EQ Coefficient Designer")
+{
+}
+
+DesignerThread::~DesignerThread()
+{
+    stopThread(1000);
+}
+
+void DesignerThread::add(Client* client)
+{
+    {
+        const juce::ScopedLock sl(lock);
+        clients.addIfNotAlreadyThere(client);
+    }
+
+    if (!isThreadRunning())
+        startThread();
+}
+
+void DesignerThread::remove(Client* client)
+{
+    const juce::ScopedLock sl(lock);
+    clients.removeFirstMatchingValue(client);
+}
+
+void DesignerThread::run()
+{
+    while (!threadShouldExit())
+    {
+        {
+            const juce::ScopedLock sl(lock);
+
+            for (auto* client : clients)
+                client->designPendingChanges();
+        }
+
+        // parameter listeners may fire on the audio thread, so they never signal us directly.
+        // Polling the flags once a millisecond keeps that side wait-free.
+        wait(1);
+    }
+}
+
+//==============================================================================
+static const char* const chainParameterIDs[] = { "LowCut Freq", "HiCut Freq", "Peak Freq", "Peak Gain", "Quality", "LowCut Slope", "HiCut Slope" };
+
+CoefficientDesigner::CoefficientDesigner(juce::AudioProcessorValueTreeState& parameterManager, const ChainParameters& chainParameters)
+    : parameterManager(parameterManager), chainParameters(chainParameters)
+{
+    for (auto* parameterID : chainParameterIDs)
+        parameterManager.addParameterListener(parameterID, this);
+
+    designerThread->add(this);
+}
+
+CoefficientDesigner::~CoefficientDesigner()
+{
+    designerThread->remove(this);
+
+    for (auto* parameterID : chainParameterIDs)
+        parameterManager.removeParameterListener(parameterID, this);
+}
+
+void CoefficientDesigner::prepare(double newSampleRate, int newOversamplingFactor)
+{
+    const juce::ScopedLock sl(designLock);
+
+    sampleRate = newSampleRate;
+    oversamplingFactor = newOversamplingFactor;
+    designedSettings = getChainSettings(chainParameters);
+    designCoefficients(designedSet, designedSettings, sampleRate, ALL_BANDS, oversamplingFactor, true);
+    publish();
+}
+
+void CoefficientDesigner::designPendingChanges()
+{
+    // lock first, so a caller that races the designer thread waits for its result instead of skipping
+    const juce::ScopedLock sl(designLock);
+
+    if (!needsDesign.exchange(false))
+        return;
+
+    if (sampleRate <= 0)
+        return;
+
+    auto chainSettings = getChainSettings(chainParameters);
+    auto changedBands = getChangedBands(designedSettings, chainSettings);
+
+    if (changedBands == 0)
+        return;
+
+    designCoefficients(designedSet, chainSettings, sampleRate, changedBands, oversamplingFactor, true);
+    designedSettings = chainSettings;
+    publish();
+}
+
+void CoefficientDesigner::writeProgram(const ChainSettings& programSettings)
+{
+    // the listener only raises needsDesign, so the whole program is designed in one go once the lock is released
+    const juce::ScopedLock sl(designLock);
+    setChainSettings(parameterManager, programSettings);
+}
+
+void CoefficientDesigner::setListener(Listener* newListener)
+{
+    const juce::ScopedLock sl(designLock);
+    listener = newListener;
+}
+
+void CoefficientDesigner::parameterChanged(const juce::String&, float)
+{
+    needsDesign.store(true);
+}
+
+void CoefficientDesigner::publish()
+{
+    coefficientSets.getWriteBuffer() = designedSet;
+    coefficientSets.publish();
+
+    if (listener != nullptr)
+        listener->coefficientsDesigned(designedSet);
+}
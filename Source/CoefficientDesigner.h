@@ -0,0 +1,227 @@
+/*
+  ==============================================================================
+
+    CoefficientDesigner.h
+    Designs the chain's biquad coefficients off the audio thread and hands
+    them over through a wait-free triple buffer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+
+
+// Normalised biquad coefficients (a0 == 1), in the same order juce::dsp::IIR::Coefficients stores them
+struct BiquadCoefficients
+{
+    float b0{ 1.f }, b1{ 0 }, b2{ 0 }, a1{ 0 }, a2{ 0 };
+};
+
+// The same responses as a topology-preserving-transform state variable filter (Zavalishin/Simper).
+// a1 a2 a3 drive the two integrators, m0 m1 m2 mix the input, band-pass and low-pass outputs.
+// a2 and a3 scale with the cutoff instead of crowding around 1 and -2 like biquad poles do,
+// so a 20 Hz cut at 384 kHz keeps its precision in float.
+struct SVFCoefficients
+{
+    float a1{ 1.f }, a2{ 0 }, a3{ 0 }, m0{ 1.f }, m1{ 0 }, m2{ 0 };
+};
+
+// Everything the chain needs for one parameter state. Plain data, so it can be copied without allocating
+struct CoefficientSet
+{
+    static constexpr int maxCutStages = 4;
+    using CutStages = std::array<BiquadCoefficients, maxCutStages>;
+
+    CutStages lowCut, highCut;
+    BiquadCoefficients peak;
+    int numLowCutStages{ 0 }, numHighCutStages{ 0 };
+
+    // the same bands for the state variable topology
+    using SVFCutStages = std::array<SVFCoefficients, maxCutStages>;
+    SVFCutStages lowCutSVF, highCutSVF;
+    SVFCoefficients peakSVF;
+
+    // dynamic mode: the peak's unity gain band pass that the dynamic gain is applied through,
+    // and the same band pass at the base rate for the detector
+    BiquadCoefficients peakBandPass, detectorBandPass;
+    SVFCoefficients peakBandPassSVF;
+    double sampleRate{ 0 };
+
+    // the peak and high cut are designed for sampleRate * oversamplingFactor, the low cut always for sampleRate
+    int oversamplingFactor{ 1 };
+};
+
+BiquadCoefficients makePeakCoefficients(double sampleRate, float frequency, float quality, float gainInDecibels);
+BiquadCoefficients makeHighPassCoefficients(double sampleRate, float frequency, double quality);
+BiquadCoefficients makeLowPassCoefficients(double sampleRate, float frequency, double quality);
+BiquadCoefficients makeBandPassCoefficients(double sampleRate, float frequency, float quality);
+BiquadCoefficients makeLowShelfCoefficients(double sampleRate, float frequency, float quality, float gainInDecibels);
+BiquadCoefficients makeHighShelfCoefficients(double sampleRate, float frequency, float quality, float gainInDecibels);
+BiquadCoefficients makeNotchCoefficients(double sampleRate, float frequency, float quality);
+
+SVFCoefficients makePeakSVFCoefficients(double sampleRate, float frequency, float quality, float gainInDecibels);
+SVFCoefficients makeHighPassSVFCoefficients(double sampleRate, float frequency, double quality);
+SVFCoefficients makeLowPassSVFCoefficients(double sampleRate, float frequency, double quality);
+SVFCoefficients makeBandPassSVFCoefficients(double sampleRate, float frequency, float quality);
+
+// Butterworth cascades matching FilterDesign::designIIR*HighOrderButterworthMethod, return the number of stages used
+int makeLowCutCoefficients(CoefficientSet::CutStages& stages, double sampleRate, float frequency, Slope slope);
+int makeHighCutCoefficients(CoefficientSet::CutStages& stages, double sampleRate, float frequency, Slope slope);
+void makeLowCutSVFCoefficients(CoefficientSet::SVFCutStages& stages, double sampleRate, float frequency, Slope slope);
+void makeHighCutSVFCoefficients(CoefficientSet::SVFCutStages& stages, double sampleRate, float frequency, Slope slope);
+
+// Redesigns the bands flagged in changedBands (see BandMask). With useSharedCache the bands go through the
+// process-wide CoefficientCache, which only pays off for settings that came straight from the parameters.
+void designCoefficients(CoefficientSet& set, const ChainSettings& chainSettings, double sampleRate, int changedBands,
+                        int oversamplingFactor = 1, bool useSharedCache = false);
+
+// Linear magnitude response at a frequency in Hz, of one biquad and of the whole chain
+double getMagnitudeForFrequency(const BiquadCoefficients& coefficients, double frequency, double sampleRate) noexcept;
+double getMagnitudeForFrequency(const CoefficientSet& set, double frequency) noexcept;
+
+// Seconds for the chain's impulse response to fall below thresholdDecibels, from the slowest pole of each band.
+// The bands run in series, so their decay times add up. includeDynamicBand adds the dynamic mode's band pass.
+double getDecayTimeSeconds(const CoefficientSet& set, double thresholdDecibels = -120.0, bool includeDynamicBand = false) noexcept;
+
+// The same for any group of stages running at one rate, from the slowest pole among them
+double getDecayTimeSeconds(const BiquadCoefficients* stages, int numStages, double sampleRate, double thresholdDecibels = -120.0) noexcept;
+
+
+//==============================================================================
+// Single-producer/single-consumer triple buffer. The writer always owns a free slot,
+// and the reader picks up the newest published one with a single atomic exchange.
+template <typename Type>
+class TripleBuffer
+{
+public:
+    Type& getWriteBuffer() noexcept { return buffers[(size_t) writeIndex]; }
+
+    void publish() noexcept
+    {
+        writeIndex = middleIndex.exchange(writeIndex | newDataFlag, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // returns true if a newer buffer was picked up
+    bool pull() noexcept
+    {
+        if ((middleIndex.load(std::memory_order_relaxed) & newDataFlag) == 0)
+            return false;
+
+        readIndex = middleIndex.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    const Type& getReadBuffer() const noexcept { return buffers[(size_t) readIndex]; }
+
+    // The reader owns its buffer until the next pull, so it may modify or swap its contents
+    Type& getReadBuffer() noexcept { return buffers[(size_t) readIndex]; }
+
+    // Not realtime safe, and neither side may be using the buffer while this runs
+    void reset(const Type& initialValue)
+    {
+        buffers.fill(initialValue);
+        writeIndex = 0;
+        readIndex = 1;
+        middleIndex.store(2);
+    }
+
+private:
+    static constexpr int indexMask = 3, newDataFlag = 4;
+
+    std::array<Type, 3> buffers;
+    int writeIndex{ 0 }, readIndex{ 1 };
+    std::atomic<int> middleIndex{ 2 };
+};
+
+
+//==============================================================================
+// One thread shared by every instance in the process, so hundreds of instances don't mean hundreds of threads.
+// It polls each of its clients for pending designs about once a millisecond.
+class DesignerThread : private juce::Thread
+{
+public:
+    struct Client
+    {
+        virtual ~Client() = default;
+        virtual void designPendingChanges() = 0;
+    };
+
+    DesignerThread();
+    ~DesignerThread() override;
+
+    void add(Client* client);
+    void remove(Client* client);
+
+private:
+    void run() override;
+
+    juce::CriticalSection lock;
+    juce::Array<Client*> clients;
+};
+
+
+//==============================================================================
+/**
+    Owns the coefficient design for one processor instance.
+
+    Parameter listeners only flag that something moved; a shared background
+    thread then redesigns the bands that changed and publishes a complete
+    CoefficientSet. The audio thread pulls the newest set at block start and
+    applies it at the next control interval boundary, unless "Control Rate"
+    has the smoother driving the IIR chain instead. The linear phase kernels
+    are built from the same sets through the listener.
+*/
+class CoefficientDesigner : public DesignerThread::Client,
+                            private juce::AudioProcessorValueTreeState::Listener
+{
+public:
+    CoefficientDesigner(juce::AudioProcessorValueTreeState& parameterManager, const ChainParameters& chainParameters);
+    ~CoefficientDesigner() override;
+
+    // Gets every set as it is published, on whichever thread designed it, with the design lock held
+    struct Listener
+    {
+        virtual ~Listener() = default;
+        virtual void coefficientsDesigned(const CoefficientSet& coefficientSet) = 0;
+    };
+
+    void setListener(Listener* newListener);
+
+    // Not realtime safe: redesigns every band for the new sample rate and publishes it straight away
+    void prepare(double sampleRate, int oversamplingFactor = 1);
+
+    // Called on the designer thread, or directly from the render thread when rendering offline
+    void designPendingChanges() override;
+
+    // Writes a whole program into the parameters with designing held off, so no set (and no linear phase
+    // kernel) is ever designed from a program written only halfway. Message thread.
+    void writeProgram(const ChainSettings& programSettings);
+
+    // Audio thread only
+    bool pullLatest() noexcept { return coefficientSets.pull(); }
+    const CoefficientSet& getLatest() const noexcept { return coefficientSets.getReadBuffer(); }
+
+private:
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void publish();
+
+    juce::AudioProcessorValueTreeState& parameterManager;
+    const ChainParameters& chainParameters;
+
+    juce::CriticalSection designLock;
+    ChainSettings designedSettings;
+    CoefficientSet designedSet;
+    double sampleRate{ 0 };
+    int oversamplingFactor{ 1 };
+
+    std::atomic<bool> needsDesign{ false };
+    TripleBuffer<CoefficientSet> coefficientSets;
+    Listener* listener{ nullptr };
+
+    juce::SharedResourcePointer<DesignerThread> designerThread;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CoefficientDesigner)
+};
@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    CoefficientSmoother.cpp
+
+  ==============================================================================
+*/
+
+#include "CoefficientSmoother.h"
+
+//==============================================================================
+void CoefficientSmoother::prepare(double newSampleRate, const ChainSettings& chainSettings, CoefficientSet& coefficientSet,
+                                  int newOversamplingFactor)
+{
+    sampleRate = newSampleRate;
+    oversamplingFactor = newOversamplingFactor;
+
+    for (auto* value : { &lowCutFreq, &highCutFreq, &peakFreq, &peakQuality })
+        value->reset(sampleRate, rampLengthSeconds);
+
+    peakGainInDecibels.reset(sampleRate, rampLengthSeconds);
+
+    jumpTo(chainSettings);
+    designCoefficients(coefficientSet, chainSettings, sampleRate, ALL_BANDS, oversamplingFactor, true);
+}
+
+void CoefficientSmoother::jumpTo(const ChainSettings& chainSettings) noexcept
+{
+    lowCutFreq.setCurrentAndTargetValue(chainSettings.lowCutFreq);
+    highCutFreq.setCurrentAndTargetValue(chainSettings.highCutFreq);
+    peakFreq.setCurrentAndTargetValue(chainSettings.peakFreq);
+    peakQuality.setCurrentAndTargetValue(chainSettings.peakQuality);
+    peakGainInDecibels.setCurrentAndTargetValue(chainSettings.peakGainInDecibels);
+    lowCutSlope = chainSettings.lowCutSlope;
+    highCutSlope = chainSettings.highCutSlope;
+
+    pendingBands = 0;
+}
+
+void CoefficientSmoother::startFrom(const ChainSettings& chainSettings) noexcept
+{
+    jumpTo(chainSettings);
+    pendingBands = ALL_BANDS;
+}
+
+void CoefficientSmoother::setTargets(const ChainSettings& chainSettings) noexcept
+{
+    lowCutFreq.setTargetValue(chainSettings.lowCutFreq);
+    highCutFreq.setTargetValue(chainSettings.highCutFreq);
+    peakFreq.setTargetValue(chainSettings.peakFreq);
+    peakQuality.setTargetValue(chainSettings.peakQuality);
+    peakGainInDecibels.setTargetValue(chainSettings.peakGainInDecibels);
+
+    if (chainSettings.lowCutSlope != lowCutSlope)
+    {
+        lowCutSlope = chainSettings.lowCutSlope;
+        pendingBands |= LOW_CUT_BAND;
+    }
+
+    if (chainSettings.highCutSlope != highCutSlope)
+    {
+        highCutSlope = chainSettings.highCutSlope;
+        pendingBands |= HIGH_CUT_BAND;
+    }
+}
+
+bool CoefficientSmoother::advance(int numSamples, CoefficientSet& coefficientSet) noexcept
+{
+    auto changedBands = pendingBands;
+    pendingBands = 0;
+
+    if (lowCutFreq.isSmoothing())
+        changedBands |= LOW_CUT_BAND;
+
+    if (highCutFreq.isSmoothing())
+        changedBands |= HIGH_CUT_BAND;
+
+    if (peakFreq.isSmoothing() || peakQuality.isSmoothing() || peakGainInDecibels.isSmoothing())
+        changedBands |= PEAK_BAND;
+
+    if (changedBands == 0)
+        return false;
+
+    ChainSettings chainSettings;
+    chainSettings.lowCutFreq = lowCutFreq.skip(numSamples);
+    chainSettings.highCutFreq = highCutFreq.skip(numSamples);
+    chainSettings.peakFreq = peakFreq.skip(numSamples);
+    chainSettings.peakQuality = peakQuality.skip(numSamples);
+    chainSettings.peakGainInDecibels = peakGainInDecibels.skip(numSamples);
+    chainSettings.lowCutSlope = lowCutSlope;
+    chainSettings.highCutSlope = highCutSlope;
+
+    // ramp values fall between the parameter steps, caching them would only churn the shared cache
+    designCoefficients(coefficientSet, chainSettings, sampleRate, changedBands, oversamplingFactor);
+    return true;
+}
+
+bool CoefficientSmoother::isSmoothing() const noexcept
+{
+    return pendingBands != 0 || lowCutFreq.isSmoothing() || highCutFreq.isSmoothing() || peakFreq.isSmoothing()
+        || peakQuality.isSmoothing() || peakGainInDecibels.isSmoothing();
+}
@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    CoefficientSmoother.h
+    Ramps the chain settings towards their targets and redesigns the moving
+    bands at a fixed control rate, independent of the host block size.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "CoefficientDesigner.h"
+
+
+//==============================================================================
+/**
+    Frequencies and Q ramp in the log domain, gain ramps in dB. Slopes are
+    discrete, so they switch straight away.
+
+    Runs on the audio thread. It never allocates, but redesigning does trig
+    math, so it only happens once per control interval while a band is moving.
+*/
+class CoefficientSmoother
+{
+public:
+    static constexpr double rampLengthSeconds = 0.05;
+
+    // Jumps straight to the given settings and designs every band
+    void prepare(double sampleRate, const ChainSettings& chainSettings, CoefficientSet& coefficientSet, int oversamplingFactor = 1);
+
+    // Jumps straight to the given settings without designing anything, for when the caller already has their coefficients
+    void jumpTo(const ChainSettings& chainSettings) noexcept;
+
+    // Jumps straight to the given settings and redesigns every band at the next advance(), for when smoothing is
+    // switched on and the set in use came from somewhere else
+    void startFrom(const ChainSettings& chainSettings) noexcept;
+
+    // Sets new ramp targets, cheap enough to call every block
+    void setTargets(const ChainSettings& chainSettings) noexcept;
+
+    // Advances the ramps by numSamples and redesigns the bands that moved.
+    // Returns true if coefficientSet was changed.
+    bool advance(int numSamples, CoefficientSet& coefficientSet) noexcept;
+
+    bool isSmoothing() const noexcept;
+
+private:
+    using LogSmoothedValue = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>;
+
+    LogSmoothedValue lowCutFreq, highCutFreq, peakFreq, peakQuality;
+    juce::SmoothedValue<float> peakGainInDecibels;
+    Slope lowCutSlope{ Slope::SLOPE_12 }, highCutSlope{ Slope::SLOPE_12 };
+
+    int pendingBands{ 0 };
+    double sampleRate{ 0 };
+    int oversamplingFactor{ 1 };
+};
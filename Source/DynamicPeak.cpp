@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    DynamicPeak.cpp
+
+  ==============================================================================
+*/
+
+#include "DynamicPeak.h"
+
+//==============================================================================
+void DynamicPeak::prepare(double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+    modulation.assign((size_t) maximumBlockSize, 0.0f);
+
+    // recomputed for the new rate on the next setParameters()
+    attackMs = releaseMs = -1.0f;
+
+    reset();
+}
+
+void DynamicPeak::reset() noexcept
+{
+    s1 = s2 = envelope = 0.0f;
+    currentModulation = targetModulation = modulationStep = 0.0f;
+    samplesUntilGain = 0;
+}
+
+void DynamicPeak::setParameters(float thresholdDecibels, float ratio, float newAttackMs, float newReleaseMs) noexcept
+{
+    thresholdGain = juce::Decibels::decibelsToGain(thresholdDecibels);
+    exponent = 1.0f / juce::jmax(1.0f, ratio) - 1.0f;
+
+    // the exp() only when a time actually moved
+    if (newAttackMs != attackMs)
+    {
+        attackMs = newAttackMs;
+        attackCoefficient = (float) std::exp(-1.0 / (juce::jmax(0.01, (double) attackMs) * 0.001 * sampleRate));
+    }
+
+    if (newReleaseMs != releaseMs)
+    {
+        releaseMs = newReleaseMs;
+        releaseCoefficient = (float) std::exp(-1.0 / (juce::jmax(0.01, (double) releaseMs) * 0.001 * sampleRate));
+    }
+}
+
+float DynamicPeak::getTargetModulation() const noexcept
+{
+    // (envelope / threshold)^(1 / ratio - 1) is the usual dB domain gain computer without the logs
+    if (envelope <= thresholdGain)
+        return 0.0f;
+
+    return std::pow(envelope / thresholdGain, exponent) - 1.0f;
+}
+
+float DynamicPeak::getNextModulation(bool detecting) noexcept
+{
+    if (samplesUntilGain == 0)
+    {
+        targetModulation = detecting ? getTargetModulation() : 0.0f;
+        modulationStep = (targetModulation - currentModulation) / (float) gainInterval;
+        samplesUntilGain = gainInterval;
+    }
+
+    // landing exactly on the target keeps rounding from building up over the ramps
+    currentModulation = --samplesUntilGain == 0 ? targetModulation : currentModulation + modulationStep;
+    return currentModulation;
+}
+
+void DynamicPeak::process(const juce::dsp::AudioBlock<float>& detector) noexcept
+{
+    // the processor splits larger host blocks, anything past the prepared size would get no modulation
+    jassert(detector.getNumSamples() <= modulation.size());
+
+    const auto numSamples = (int) juce::jmin(detector.getNumSamples(), modulation.size());
+    const auto numChannels = (int) detector.getNumChannels();
+    auto* output = modulation.data();
+
+    if (numChannels == 0)
+    {
+        processBypassed(numSamples);
+        return;
+    }
+
+    // the modulation buffer doubles as scratch space for the averaged detector signal
+    juce::FloatVectorOperations::copy(output, detector.getChannelPointer(0), numSamples);
+
+    for (int channel = 1; channel < numChannels; ++channel)
+        juce::FloatVectorOperations::add(output, detector.getChannelPointer((size_t) channel), numSamples);
+
+    const auto scale = 1.0f / (float) numChannels;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto x = output[i] * scale;
+        const auto y = bandPass.b0 * x + s1;
+        s1 = bandPass.b1 * x - bandPass.a1 * y + s2;
+        s2 = bandPass.b2 * x - bandPass.a2 * y;
+
+        const auto level = std::abs(y);
+        envelope = level + (level > envelope ? attackCoefficient : releaseCoefficient) * (envelope - level);
+
+        output[i] = getNextModulation(true);
+    }
+}
+
+void DynamicPeak::processBypassed(int numSamples) noexcept
+{
+    // the detector starts from scratch when the mode comes back on
+    s1 = s2 = envelope = 0.0f;
+
+    auto* output = modulation.data();
+
+    for (int i = 0; i < juce::jmin(numSamples, (int) modulation.size()); ++i)
+        output[i] = getNextModulation(false);
+}
@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    DynamicPeak.h
+    The detector and gain computer for the peak band's dynamic mode. It only
+    produces a gain per sample, the filter engine applies it through the
+    peak's band pass.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientDesigner.h"
+
+
+//==============================================================================
+/**
+    Downward compression of the peak band. The detector signal (the main
+    input or the sidechain, averaged over its channels) goes through the same
+    band pass as the peak, a peak envelope follower tracks it, and above the
+    threshold the band is turned down by the ratio.
+
+    The envelope runs every sample, the gain computer's pow() only once every
+    gainInterval samples with the gain ramped linearly in between, so the
+    whole detector costs about as much as one more mono biquad.
+
+    Runs on the audio thread, never allocates after prepare().
+*/
+class DynamicPeak
+{
+public:
+    static constexpr int gainInterval = 16;
+
+    void prepare(double sampleRate, int maximumBlockSize);
+    void reset() noexcept;
+
+    void setDetectorBandPass(const BiquadCoefficients& coefficients) noexcept { bandPass = coefficients; }
+    void setParameters(float thresholdDecibels, float ratio, float attackMs, float releaseMs) noexcept;
+
+    // Fills the modulation with the band's dynamic gain minus one, one value per detector sample
+    void process(const juce::dsp::AudioBlock<float>& detector) noexcept;
+
+    // Ramps whatever gain is left back to unity, so switching the mode off doesn't click
+    void processBypassed(int numSamples) noexcept;
+    bool isModulating() const noexcept { return currentModulation != 0.0f || targetModulation != 0.0f; }
+
+    const float* getModulation() const noexcept { return modulation.data(); }
+
+private:
+    float getTargetModulation() const noexcept;
+    float getNextModulation(bool detecting) noexcept;
+
+    double sampleRate{ 0 };
+    std::vector<float> modulation;
+
+    BiquadCoefficients bandPass;
+    float s1{ 0 }, s2{ 0 };
+    float envelope{ 0 };
+
+    float thresholdGain{ 1.0f }, exponent{ 0 };
+    float attackMs{ -1.0f }, releaseMs{ -1.0f };
+    float attackCoefficient{ 0 }, releaseCoefficient{ 0 };
+
+    float currentModulation{ 0 }, targetModulation{ 0 }, modulationStep{ 0 };
+    int samplesUntilGain{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DynamicPeak)
+};
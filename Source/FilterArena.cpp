@@ -0,0 +1,45 @@
+/*
+  ==============================================================================
+
+    FilterArena.cpp
+
+  ==============================================================================
+*/
+
+#include "FilterArena.h"
+
+//==============================================================================
+void FilterArena::reset(size_t numBytes)
+{
+    capacity = numBytes;
+    used = 0;
+
+    if (numBytes == 0)
+    {
+        memory.reset();
+        base = nullptr;
+        return;
+    }
+
+    // room to move the start up to the next cache line
+    memory.setSize(numBytes + alignment);
+    memory.fillWith(0);
+
+    const auto address = (size_t) reinterpret_cast<juce::pointer_sized_uint>(memory.getData());
+    base = static_cast<char*>(memory.getData()) + (align(address) - address);
+}
+
+void* FilterArena::allocate(size_t numBytes) noexcept
+{
+    const auto alignedBytes = align(numBytes);
+
+    // the caller sized the arena for less than it's now carving
+    jassert(used + alignedBytes <= capacity);
+
+    if (used + alignedBytes > capacity)
+        return nullptr;
+
+    auto* piece = base + used;
+    used += alignedBytes;
+    return piece;
+}
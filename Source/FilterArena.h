@@ -0,0 +1,46 @@
+/*
+  ==============================================================================
+
+    FilterArena.h
+    One cache-line aligned block of memory that an instance's filter engines
+    carve their coefficients, state and scratch space from.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+
+//==============================================================================
+/**
+    A bump allocator over a single allocation. reset() makes room for a known
+    number of bytes, allocate() then hands out zeroed, cache-line aligned
+    pieces in order. Nothing is freed on its own, the next reset() throws
+    every piece away at once, so whoever resets it re-prepares everything
+    that was carved from it.
+
+    Not realtime safe, engines only carve from it in prepare().
+*/
+class FilterArena
+{
+public:
+    static constexpr size_t alignment = 64;
+
+    static size_t align(size_t numBytes) noexcept { return (numBytes + alignment - 1) & ~(alignment - 1); }
+
+    // Throws away every piece handed out so far and makes room for numBytes, zeroed. 0 frees the memory.
+    void reset(size_t numBytes);
+
+    // The next numBytes, aligned and zeroed. Returns nullptr if reset() didn't leave room for them.
+    void* allocate(size_t numBytes) noexcept;
+
+    // Bytes allocated from the system, alignment slack included
+    size_t getSize() const noexcept { return memory.getSize(); }
+
+private:
+    juce::MemoryBlock memory;
+    char* base{ nullptr };
+    size_t capacity{ 0 }, used{ 0 };
+};
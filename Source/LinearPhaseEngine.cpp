@@ -0,0 +1,227 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEngine.cpp
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseEngine.h"
+
+//==============================================================================
+void LinearPhaseEngine::prepare(const juce::dsp::ProcessSpec& spec, int newFIRLength)
+{
+    jassert(juce::isPowerOfTwo(newFIRLength) && newFIRLength >= partitionSize);
+
+    const juce::ScopedLock sl(designLock);
+
+    sampleRate = spec.sampleRate;
+    firLength = newFIRLength;
+    numPartitions = firLength / partitionSize;
+
+    designFFT = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(firLength)));
+    designBuffer.assign((size_t) firLength * 2, 0.0f);
+    partitionBuffer.assign((size_t) partitionSize * 4, 0.0f);
+
+    // one extra point so the window peaks exactly on the kernel's centre tap
+    window.assign((size_t) firLength + 1, 0.0f);
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), window.size(),
+                                                             juce::dsp::WindowingFunction<float>::blackman, false);
+
+    Kernel emptyKernel;
+    emptyKernel.spectra.assign((size_t) (numPartitions * getSpectrumSize()), 0.0f);
+    kernels.reset(emptyKernel);
+    activeKernel = emptyKernel;
+    incomingKernel = nullptr;
+
+    channels.resize(spec.numChannels);
+
+    for (auto& channel : channels)
+    {
+        channel.input.assign((size_t) partitionSize * 2, 0.0f);
+        channel.output.assign((size_t) partitionSize, 0.0f);
+        channel.delayLine.assign((size_t) (numPartitions * getSpectrumSize()), 0.0f);
+    }
+
+    fftBuffer.assign((size_t) partitionSize * 4, 0.0f);
+    accumulator.assign((size_t) getSpectrumSize(), 0.0f);
+    fadeBuffer.assign((size_t) partitionSize, 0.0f);
+
+    // about 20 ms, rounded to whole partitions since the fade runs a partition at a time
+    fadeLength = juce::jmax(1, juce::roundToInt(0.02 * sampleRate / partitionSize)) * partitionSize;
+}
+
+void LinearPhaseEngine::release()
+{
+    const juce::ScopedLock sl(designLock);
+
+    firLength = numPartitions = 0;
+    designFFT.reset();
+
+    for (auto* buffer : { &designBuffer, &window, &partitionBuffer, &fftBuffer, &accumulator, &fadeBuffer })
+        std::vector<float>().swap(*buffer);
+
+    kernels.reset({});
+    activeKernel = {};
+    incomingKernel = nullptr;
+    channels.clear();
+}
+
+void LinearPhaseEngine::reset() noexcept
+{
+    if (kernels.pull())
+        std::swap(activeKernel.spectra, kernels.getReadBuffer().spectra);
+
+    incomingKernel = nullptr;
+    fifoPosition = delayLinePosition = fadePosition = 0;
+
+    for (auto& channel : channels)
+        for (auto* buffer : { &channel.input, &channel.output, &channel.delayLine })
+            std::fill(buffer->begin(), buffer->end(), 0.0f);
+}
+
+//==============================================================================
+void LinearPhaseEngine::coefficientsDesigned(const CoefficientSet& coefficientSet)
+{
+    const juce::ScopedLock sl(designLock);
+
+    if (!isPrepared() || coefficientSet.sampleRate != sampleRate)
+        return;
+
+    // sample the chain's magnitude on the FIR's own frequency grid, with zero phase
+    auto* spectrum = designBuffer.data();
+    std::fill(designBuffer.begin(), designBuffer.end(), 0.0f);
+
+    for (int bin = 0; bin <= firLength / 2; ++bin)
+        spectrum[bin * 2] = (float) getMagnitudeForFrequency(coefficientSet, bin * sampleRate / firLength);
+
+    designFFT->performRealOnlyInverseTransform(spectrum);
+
+    // the zero phase response is centred on sample 0, rotate it to the middle and window it,
+    // which gives a symmetric, linear phase kernel with firLength / 2 samples of delay
+    auto& kernel = kernels.getWriteBuffer();
+    const auto halfLength = firLength / 2;
+
+    for (int partition = 0; partition < numPartitions; ++partition)
+    {
+        std::fill(partitionBuffer.begin(), partitionBuffer.end(), 0.0f);
+
+        for (int i = 0; i < partitionSize; ++i)
+        {
+            const auto n = partition * partitionSize + i;
+            partitionBuffer[(size_t) i] = spectrum[(n + halfLength) % firLength] * window[(size_t) n];
+        }
+
+        kernelFFT.performRealOnlyForwardTransform(partitionBuffer.data(), true);
+        std::copy(partitionBuffer.begin(), partitionBuffer.begin() + getSpectrumSize(),
+                  kernel.spectra.begin() + partition * getSpectrumSize());
+    }
+
+    kernels.publish();
+}
+
+//==============================================================================
+void LinearPhaseEngine::process(const juce::dsp::AudioBlock<float>& block) noexcept
+{
+    jassert(isPrepared());
+
+    const auto numSamples = (int) block.getNumSamples();
+    const auto numChannels = juce::jmin((int) block.getNumChannels(), (int) channels.size());
+
+    for (int start = 0; start < numSamples;)
+    {
+        const auto numToCopy = juce::jmin(partitionSize - fifoPosition, numSamples - start);
+
+        // new input goes into the second half, the output is what the previous partition produced
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* samples = block.getChannelPointer((size_t) channel) + start;
+            auto& state = channels[(size_t) channel];
+
+            std::copy(samples, samples + numToCopy, state.input.begin() + partitionSize + fifoPosition);
+            std::copy(state.output.begin() + fifoPosition, state.output.begin() + fifoPosition + numToCopy, samples);
+        }
+
+        fifoPosition += numToCopy;
+        start += numToCopy;
+
+        if (fifoPosition == partitionSize)
+        {
+            processPartition();
+            fifoPosition = 0;
+        }
+    }
+}
+
+void LinearPhaseEngine::processPartition() noexcept
+{
+    // a new kernel only starts fading in once the previous fade has finished
+    if (incomingKernel == nullptr && kernels.pull())
+    {
+        incomingKernel = &kernels.getReadBuffer();
+        fadePosition = 0;
+    }
+
+    for (int channel = 0; channel < (int) channels.size(); ++channel)
+    {
+        auto& state = channels[(size_t) channel];
+
+        // transform the last two partitions of input into the newest delay line slot
+        std::fill(fftBuffer.begin(), fftBuffer.end(), 0.0f);
+        std::copy(state.input.begin(), state.input.end(), fftBuffer.begin());
+        partitionFFT.performRealOnlyForwardTransform(fftBuffer.data(), true);
+        std::copy(fftBuffer.begin(), fftBuffer.begin() + getSpectrumSize(),
+                  state.delayLine.begin() + delayLinePosition * getSpectrumSize());
+
+        convolve(channel, activeKernel, state.output.data());
+
+        if (incomingKernel != nullptr)
+        {
+            convolve(channel, *incomingKernel, fadeBuffer.data());
+
+            for (int i = 0; i < partitionSize; ++i)
+            {
+                const auto gain = (float) (fadePosition + i) / (float) fadeLength;
+                state.output[(size_t) i] += gain * (fadeBuffer[(size_t) i] - state.output[(size_t) i]);
+            }
+        }
+
+        std::copy(state.input.begin() + partitionSize, state.input.end(), state.input.begin());
+    }
+
+    delayLinePosition = (delayLinePosition + 1) % numPartitions;
+
+    if (incomingKernel != nullptr && (fadePosition += partitionSize) >= fadeLength)
+    {
+        // the reader owns the pulled buffer until it pulls again, so the storage can simply be swapped
+        std::swap(activeKernel.spectra, incomingKernel->spectra);
+        incomingKernel = nullptr;
+    }
+}
+
+void LinearPhaseEngine::convolve(int channel, const Kernel& kernel, float* output) noexcept
+{
+    const auto spectrumSize = getSpectrumSize();
+    auto* accumulated = accumulator.data();
+    std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+
+    // newest input spectrum against the first kernel partition, the one before against the second, and so on
+    for (int partition = 0; partition < numPartitions; ++partition)
+    {
+        const auto slot = (delayLinePosition - partition + numPartitions) % numPartitions;
+        const auto* x = channels[(size_t) channel].delayLine.data() + slot * spectrumSize;
+        const auto* h = kernel.spectra.data() + partition * spectrumSize;
+
+        for (int i = 0; i < spectrumSize; i += 2)
+        {
+            accumulated[i] += x[i] * h[i] - x[i + 1] * h[i + 1];
+            accumulated[i + 1] += x[i] * h[i + 1] + x[i + 1] * h[i];
+        }
+    }
+
+    // overlap-save: only the second half of the inverse transform is free of wrap-around
+    std::copy(accumulator.begin(), accumulator.end(), fftBuffer.begin());
+    std::fill(fftBuffer.begin() + spectrumSize, fftBuffer.end(), 0.0f);
+    partitionFFT.performRealOnlyInverseTransform(fftBuffer.data());
+    std::copy(fftBuffer.begin() + partitionSize, fftBuffer.begin() + partitionSize * 2, output);
+}
@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEngine.h
+    Linear-phase version of the chain: the IIR magnitude response sampled
+    into a symmetric FIR and run through a uniformly partitioned convolver.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientDesigner.h"
+
+
+//==============================================================================
+/**
+    Kernels are built from each published CoefficientSet on the thread that
+    designed it (normally the shared designer thread), handed over through a
+    triple buffer, and crossfaded in on the audio thread.
+
+    The convolver is uniformly partitioned overlap-save: the kernel is split
+    into partitionSize blocks, each held as a spectrum, and every input
+    partition is multiplied against a frequency domain delay line of the past
+    ones. Host block size doesn't matter, input goes through a FIFO, so the
+    latency is always firLength / 2 + partitionSize.
+*/
+class LinearPhaseEngine : public CoefficientDesigner::Listener
+{
+public:
+    static constexpr int partitionOrder = 9;
+    static constexpr int partitionSize = (1 << partitionOrder) / 2;
+
+    // Not realtime safe, the audio thread must not be running process() meanwhile
+    void prepare(const juce::dsp::ProcessSpec& spec, int firLength);
+    void release();
+
+    bool isPrepared() const noexcept { return firLength > 0; }
+    int getFIRLength() const noexcept { return firLength; }
+    int getLatencySamples() const noexcept { return firLength / 2 + partitionSize; }
+
+    // Clears the convolution state and switches straight to the newest kernel, without a crossfade
+    void reset() noexcept;
+
+    // Audio thread
+    void process(const juce::dsp::AudioBlock<float>& block) noexcept;
+
+private:
+    // One kernel as spectra of its partitions, (partitionSize + 1) interleaved complex bins each
+    struct Kernel
+    {
+        std::vector<float> spectra;
+    };
+
+    void coefficientsDesigned(const CoefficientSet& coefficientSet) override;
+
+    void processPartition() noexcept;
+    void convolve(int channel, const Kernel& kernel, float* output) noexcept;
+
+    int getSpectrumSize() const noexcept { return (partitionSize + 1) * 2; }
+
+    //==============================================================================
+    // kernel design, guarded by designLock since it runs on the designer thread
+    juce::CriticalSection designLock;
+    std::unique_ptr<juce::dsp::FFT> designFFT;
+    juce::dsp::FFT kernelFFT{ partitionOrder };
+    std::vector<float> designBuffer, window, partitionBuffer;
+
+    TripleBuffer<Kernel> kernels;
+
+    //==============================================================================
+    // audio thread state
+    juce::dsp::FFT partitionFFT{ partitionOrder };
+
+    Kernel activeKernel;
+    Kernel* incomingKernel{ nullptr };
+    int fadePosition{ 0 }, fadeLength{ 0 };
+
+    struct ChannelState
+    {
+        std::vector<float> input;       // previous and current partition, 2 * partitionSize
+        std::vector<float> output;      // the last convolved partition, read out while the next one fills
+        std::vector<float> delayLine;   // input spectra, numPartitions of them
+    };
+
+    std::vector<ChannelState> channels;
+    std::vector<float> fftBuffer, accumulator, fadeBuffer;
+
+    int firLength{ 0 }, numPartitions{ 0 };
+    int fifoPosition{ 0 }, delayLinePosition{ 0 };
+    double sampleRate{ 0 };
+};
@@ -0,0 +1,221 @@
+/*
+  ==============================================================================
+
+    ParallelFilterEngine.cpp
+
+  ==============================================================================
+*/
+
+#include "ParallelFilterEngine.h"
+
+//==============================================================================
+size_t ParallelFilterEngine::getArenaBytes(const juce::dsp::ProcessSpec& spec) noexcept
+{
+    return FilterArena::align(sizeof(ChannelState) * (size_t) spec.numChannels);
+}
+
+void ParallelFilterEngine::prepare(const juce::dsp::ProcessSpec& spec, FilterArena* sharedArena)
+{
+    static_assert(std::is_trivially_copyable<ChannelState>::value && std::is_trivially_destructible<ChannelState>::value,
+                  "channel state lives in the raw arena and is never destroyed");
+
+    auto* arena = sharedArena;
+
+    if (arena == nullptr)
+    {
+        arena = &ownArena;
+        ownArena.reset(getArenaBytes(spec));
+    }
+    else
+    {
+        ownArena.reset(0);
+    }
+
+    numChannels = (size_t) spec.numChannels;
+    channels = static_cast<ChannelState*>(arena->allocate(sizeof(ChannelState) * numChannels));
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+        new (channels + channel) ChannelState();
+
+    setSections({});
+    reset();
+}
+
+void ParallelFilterEngine::reset() noexcept
+{
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        auto& state = channels[channel];
+        state.w1.fill(Register::expand(0.0f));
+        state.w2.fill(Register::expand(0.0f));
+        state.cascadeS1.fill(0.0f);
+        state.cascadeS2.fill(0.0f);
+    }
+}
+
+void ParallelFilterEngine::copyFrom(const ParallelFilterEngine& other) noexcept
+{
+    jassert(other.numChannels == numChannels);
+
+    groups = other.groups;
+    cascadeSections = other.cascadeSections;
+    numSections = other.numSections;
+    directGain = other.directGain;
+    isParallel = other.isParallel;
+    parallel = other.parallel;
+
+    std::copy(other.channels, other.channels + juce::jmin(numChannels, other.numChannels), channels);
+}
+
+void ParallelFilterEngine::setSections(const ParallelSections& sections) noexcept
+{
+    if (sections.isParallel != isParallel)
+        reset();
+
+    numSections = juce::jlimit(0, maxUserBands, sections.numSections);
+    directGain = sections.directGain;
+    isParallel = sections.isParallel;
+    cascadeSections = sections.sections;
+
+    for (int k = 0; k < maxUserBands; ++k)
+    {
+        const auto& section = sections.sections[(size_t) k];
+        auto& group = groups[(size_t) (k / numLanes)];
+        const auto lane = (size_t) (k % numLanes);
+        const auto used = k < numSections && isParallel;
+
+        group.b0.set(lane, used ? section.b0 : 0.0f);
+        group.b1.set(lane, used ? section.b1 : 0.0f);
+        group.minusA1.set(lane, used ? -section.a1 : 0.0f);
+        group.minusA2.set(lane, used ? -section.a2 : 0.0f);
+
+        // a band that was switched off or dropped out of the count shouldn't ring on from its old state
+        const auto silent = k >= numSections || (isParallel ? section.b0 == 0.0f && section.b1 == 0.0f && section.a1 == 0.0f && section.a2 == 0.0f
+                                                            : section.b0 == 1.0f && section.b1 == 0.0f && section.b2 == 0.0f
+                                                              && section.a1 == 0.0f && section.a2 == 0.0f);
+        if (!silent)
+            continue;
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            auto& state = channels[channel];
+            state.w1[(size_t) (k / numLanes)].set(lane, 0.0f);
+            state.w2[(size_t) (k / numLanes)].set(lane, 0.0f);
+            state.cascadeS1[(size_t) k] = 0.0f;
+            state.cascadeS2[(size_t) k] = 0.0f;
+        }
+    }
+
+    parallel = getParallel((numSections + numLanes - 1) / numLanes);
+}
+
+void ParallelFilterEngine::process(const juce::dsp::AudioBlock<float>& block) noexcept
+{
+    const auto numSamples = block.getNumSamples();
+    const auto channelsToProcess = juce::jmin(block.getNumChannels(), numChannels);
+
+    if (numSections == 0)
+        return;
+
+    for (size_t channel = 0; channel < channelsToProcess; ++channel)
+    {
+        auto* samples = block.getChannelPointer(channel);
+
+        if (isParallel)
+            parallel(groups.data(), channels[channel], directGain, samples, numSamples);
+        else
+            processCascade(channels[channel], samples, numSamples);
+    }
+}
+
+float ParallelFilterEngine::getStateMagnitude() const noexcept
+{
+    auto magnitude = 0.0f;
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        const auto& state = channels[channel];
+
+        for (int g = 0; g < maxGroups; ++g)
+            for (size_t lane = 0; lane < (size_t) numLanes; ++lane)
+                magnitude = juce::jmax(magnitude, std::abs(state.w1[(size_t) g].get(lane)), std::abs(state.w2[(size_t) g].get(lane)));
+
+        for (int k = 0; k < maxUserBands; ++k)
+            magnitude = juce::jmax(magnitude, std::abs(state.cascadeS1[(size_t) k]), std::abs(state.cascadeS2[(size_t) k]));
+    }
+
+    return magnitude;
+}
+
+//==============================================================================
+template <int NumGroups>
+void ParallelFilterEngine::processParallel(const SectionGroup* sectionGroups, ChannelState& state, float directGain,
+                                           float* samples, size_t numSamples) noexcept
+{
+    // the state lives in locals for the block, so the compiler can keep it in registers
+    std::array<Register, (size_t) NumGroups> w1, w2;
+
+    for (size_t g = 0; g < (size_t) NumGroups; ++g)
+    {
+        w1[g] = state.w1[g];
+        w2[g] = state.w2[g];
+    }
+
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        const auto x = Register::expand(samples[i]);
+        auto sum = Register::expand(0.0f);
+
+        for (size_t g = 0; g < (size_t) NumGroups; ++g)
+        {
+            const auto& group = sectionGroups[g];
+            const auto w = x + group.minusA1 * w1[g] + group.minusA2 * w2[g];
+
+            sum += group.b0 * w + group.b1 * w1[g];
+            w2[g] = w1[g];
+            w1[g] = w;
+        }
+
+        samples[i] = directGain * samples[i] + sum.sum();
+    }
+
+    for (size_t g = 0; g < (size_t) NumGroups; ++g)
+    {
+        state.w1[g] = w1[g];
+        state.w2[g] = w2[g];
+    }
+}
+
+template <int... NumGroups>
+ParallelFilterEngine::ParallelFunction ParallelFilterEngine::getParallel(int numGroups, std::integer_sequence<int, NumGroups...>) noexcept
+{
+    static constexpr ParallelFunction functions[] = { &processParallel<NumGroups>... };
+    return functions[juce::jlimit(0, maxGroups, numGroups)];
+}
+
+ParallelFilterEngine::ParallelFunction ParallelFilterEngine::getParallel(int numGroups) noexcept
+{
+    return getParallel(numGroups, std::make_integer_sequence<int, maxGroups + 1>());
+}
+
+void ParallelFilterEngine::processCascade(ChannelState& state, float* samples, size_t numSamples) const noexcept
+{
+    for (int k = 0; k < numSections; ++k)
+    {
+        const auto& section = cascadeSections[(size_t) k];
+        auto s1 = state.cascadeS1[(size_t) k], s2 = state.cascadeS2[(size_t) k];
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const auto x = samples[i];
+            const auto y = section.b0 * x + s1;
+
+            s1 = section.b1 * x - section.a1 * y + s2;
+            s2 = section.b2 * x - section.a2 * y;
+            samples[i] = y;
+        }
+
+        state.cascadeS1[(size_t) k] = s1;
+        state.cascadeS2[(size_t) k] = s2;
+    }
+}
@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    ParallelFilterEngine.h
+    Runs the user bands as a parallel sum of second-order sections, the
+    sections spread across the lanes of a juce::dsp::SIMDRegister.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "UserBands.h"
+#include "FilterArena.h"
+
+
+//==============================================================================
+/**
+    SIMDFilterEngine puts channels in the lanes because its sections have to
+    run one after another. In parallel form every section sees the same
+    input, so here the lanes hold sections instead: each input sample is
+    broadcast to a register, every lane runs its own direct form II section,
+    and the lanes are summed with the direct gain term.
+
+    Direct form II because its state is the input run through the section's
+    poles alone. Moving one band changes every section's residues but only
+    that band's poles, so the other sections' state stays exactly what their
+    new coefficients expect and the change lands without a transient.
+
+    24 bands take 6 register groups with SSE/NEON and 3 with AVX, and the
+    loop is template-instantiated for the number of groups in use, picked
+    whenever the sections change.
+
+    If the designer had to fall back to the cascade, the same sections run
+    one after another in scalar code instead.
+*/
+class ParallelFilterEngine
+{
+public:
+    using Register = juce::dsp::SIMDRegister<float>;
+
+    static constexpr int numLanes = (int) Register::size();
+    static constexpr int maxGroups = (maxUserBands + numLanes - 1) / numLanes;
+
+    // Bytes prepare() carves from the arena for this spec
+    static size_t getArenaBytes(const juce::dsp::ProcessSpec& spec) noexcept;
+
+    // Not realtime safe. With sharedArena the channel state comes from there, and the engine must be prepared
+    // again whenever that arena is reset.
+    void prepare(const juce::dsp::ProcessSpec& spec, FilterArena* sharedArena = nullptr);
+    void reset() noexcept;
+
+    // Switching between parallel and cascade form resets the state, which means something different in each.
+    // Within one form the state carries on.
+    void setSections(const ParallelSections& sections) noexcept;
+    bool isParallelForm() const noexcept { return isParallel; }
+
+    // Copies sections and filter state from an engine prepared with the same spec
+    void copyFrom(const ParallelFilterEngine& other) noexcept;
+
+    void process(const juce::dsp::AudioBlock<float>& block) noexcept;
+
+    // Largest absolute filter state across every channel, 0 once the sections have fully settled
+    float getStateMagnitude() const noexcept;
+
+    // Bytes used by this instance, its own arena included but not a shared one
+    size_t getMemoryFootprint() const noexcept { return sizeof(*this) + ownArena.getSize(); }
+
+private:
+    // b0 b1, and a1 a2 negated, one section per lane. b2 is always 0 in parallel form.
+    struct SectionGroup
+    {
+        Register b0, b1, minusA1, minusA2;
+    };
+
+    struct ChannelState
+    {
+        // the last two pole states of every parallel section
+        std::array<Register, (size_t) maxGroups> w1, w2;
+
+        // the cascade fallback, one scalar section after another
+        std::array<float, (size_t) maxUserBands> cascadeS1, cascadeS2;
+    };
+
+    using ParallelFunction = void (*)(const SectionGroup*, ChannelState&, float, float*, size_t) noexcept;
+
+    template <int NumGroups>
+    static void processParallel(const SectionGroup* sectionGroups, ChannelState& state, float directGain, float* samples, size_t numSamples) noexcept;
+
+    static ParallelFunction getParallel(int numGroups) noexcept;
+
+    template <int... NumGroups>
+    static ParallelFunction getParallel(int numGroups, std::integer_sequence<int, NumGroups...>) noexcept;
+
+    void processCascade(ChannelState& state, float* samples, size_t numSamples) const noexcept;
+
+    std::array<SectionGroup, (size_t) maxGroups> groups;
+    std::array<BiquadCoefficients, (size_t) maxUserBands> cascadeSections;
+    FilterArena ownArena;
+    ChannelState* channels{ nullptr };
+    size_t numChannels{ 0 };
+
+    int numSections{ 0 };
+    float directGain{ 1.0f };
+    bool isParallel{ true };
+    ParallelFunction parallel{ nullptr };
+};
@@ -0,0 +1,232 @@
+/*
+  ==============================================================================
+
+    ParameterControls.cpp
+
+  ==============================================================================
+*/
+
+#include "ParameterControls.h"
+
+//==============================================================================
+ParameterSlider::ParameterSlider(juce::RangedAudioParameter& parameterToControl, const juce::String& label, const juce::String& valueSuffix)
+    : juce::Slider(juce::Slider::RotaryHorizontalVerticalDrag, juce::Slider::TextBoxBelow),
+      parameter(&parameterToControl),
+      suffix(valueSuffix)
+{
+    setName(label);
+    setTextBoxStyle(juce::Slider::TextBoxBelow, false, ControlGroup::columnWidth - 4, 18);
+    setScrollWheelEnabled(true);
+
+    textFromValueFunction = [this](double value)
+    {
+        return parameter->getText(parameter->convertTo0to1((float) value), 0) + suffix;
+    };
+
+    valueFromTextFunction = [this](const juce::String& text)
+    {
+        const auto number = suffix.isEmpty() ? text : text.upToFirstOccurrenceOf(suffix, false, false);
+        return (double) parameter->convertFrom0to1(parameter->getValueForText(number.trim()));
+    };
+
+    setParameter(parameterToControl);
+}
+
+void ParameterSlider::setParameter(juce::RangedAudioParameter& newParameter)
+{
+    parameter = &newParameter;
+
+    // the slider maps through the parameter's own range, so skew and snapping match what the host sees
+    const auto range = parameter->getNormalisableRange();
+    setNormalisableRange({ (double) range.start, (double) range.end,
+                           [range](double, double, double normalised) { return (double) range.convertFrom0to1((float) normalised); },
+                           [range](double, double, double value) { return (double) range.convertTo0to1((float) value); },
+                           [range](double, double, double value) { return (double) range.snapToLegalValue((float) value); } });
+
+    setDoubleClickReturnValue(true, parameter->convertFrom0to1(parameter->getDefaultValue()));
+
+    lastValue = -1.0f;
+    refresh();
+}
+
+bool ParameterSlider::refresh()
+{
+    const auto value = parameter->getValue();
+
+    if (value == lastValue)
+        return false;
+
+    lastValue = value;
+    setValue(parameter->convertFrom0to1(value), juce::dontSendNotification);
+    return true;
+}
+
+void ParameterSlider::valueChanged()
+{
+    // drags and the mouse wheel are already wrapped in a gesture, typed values aren't
+    if (!isDragging)
+        parameter->beginChangeGesture();
+
+    parameter->setValueNotifyingHost(parameter->convertTo0to1((float) getValue()));
+
+    if (!isDragging)
+        parameter->endChangeGesture();
+
+    lastValue = parameter->getValue();
+}
+
+void ParameterSlider::startedDragging()
+{
+    isDragging = true;
+    parameter->beginChangeGesture();
+}
+
+void ParameterSlider::stoppedDragging()
+{
+    parameter->endChangeGesture();
+    isDragging = false;
+}
+
+//==============================================================================
+ParameterComboBox::ParameterComboBox(juce::RangedAudioParameter& parameterToControl)
+    : parameter(&parameterToControl)
+{
+    onChange = [this] { selectionChanged(); };
+    setParameter(parameterToControl);
+}
+
+void ParameterComboBox::setParameter(juce::RangedAudioParameter& newParameter)
+{
+    parameter = &newParameter;
+
+    clear(juce::dontSendNotification);
+    addItemList(parameter->getAllValueStrings(), 1);
+
+    lastValue = -1.0f;
+    refresh();
+}
+
+bool ParameterComboBox::refresh()
+{
+    const auto value = parameter->getValue();
+
+    if (value == lastValue)
+        return false;
+
+    lastValue = value;
+    setSelectedItemIndex(juce::roundToInt(parameter->convertFrom0to1(value)), juce::dontSendNotification);
+    return true;
+}
+
+void ParameterComboBox::selectionChanged()
+{
+    const auto index = getSelectedItemIndex();
+
+    if (index < 0)
+        return;
+
+    parameter->beginChangeGesture();
+    parameter->setValueNotifyingHost(parameter->convertTo0to1((float) index));
+    parameter->endChangeGesture();
+
+    lastValue = parameter->getValue();
+}
+
+//==============================================================================
+ControlGroup::ControlGroup(const juce::String& groupTitle, int columns)
+    : title(groupTitle), numColumns(juce::jmax(1, columns))
+{
+}
+
+ParameterSlider& ControlGroup::addSlider(juce::RangedAudioParameter& parameter, const juce::String& label, const juce::String& suffix)
+{
+    sliders.push_back(std::make_unique<ParameterSlider>(parameter, label, suffix));
+    addAndMakeVisible(*sliders.back());
+    return *sliders.back();
+}
+
+ParameterComboBox& ControlGroup::addComboBox(juce::RangedAudioParameter& parameter, const juce::String& label)
+{
+    comboBoxes.push_back(std::make_unique<ParameterComboBox>(parameter));
+    comboBoxes.back()->setName(label);
+    hasComboBoxLabels = hasComboBoxLabels || label.isNotEmpty();
+
+    addAndMakeVisible(*comboBoxes.back());
+    return *comboBoxes.back();
+}
+
+void ControlGroup::setHeaderComponent(juce::Component& component)
+{
+    headerComponent = &component;
+    addAndMakeVisible(component);
+}
+
+bool ControlGroup::refresh()
+{
+    auto changed = false;
+
+    for (auto& slider : sliders)
+        changed = slider->refresh() || changed;
+
+    for (auto& comboBox : comboBoxes)
+        changed = comboBox->refresh() || changed;
+
+    return changed;
+}
+
+int ControlGroup::getPreferredHeight() const noexcept
+{
+    return titleHeight + getNumRows(sliders.size()) * sliderHeight + getNumRows(comboBoxes.size()) * getComboBoxRowHeight() + 4;
+}
+
+void ControlGroup::paint(juce::Graphics& g)
+{
+    const auto bounds = getLocalBounds().toFloat().reduced(1.0f);
+
+    g.setColour(juce::Colours::white.withAlpha(0.06f));
+    g.fillRoundedRectangle(bounds, 4.0f);
+
+    g.setColour(juce::Colours::white.withAlpha(0.8f));
+    g.setFont(juce::FontOptions(14.0f, juce::Font::bold));
+    g.drawText(title, getLocalBounds().removeFromTop(titleHeight).reduced(6, 0), juce::Justification::centredLeft);
+
+    // names above each knob and labelled combo box, the slider's text box below shows the value
+    g.setColour(juce::Colours::white.withAlpha(0.6f));
+    g.setFont(juce::FontOptions(12.0f));
+
+    for (auto& slider : sliders)
+        g.drawText(slider->getName(), slider->getBounds().withHeight(labelHeight).translated(0, -labelHeight), juce::Justification::centred);
+
+    for (auto& comboBox : comboBoxes)
+        g.drawText(comboBox->getName(), comboBox->getBounds().withHeight(labelHeight).translated(0, -labelHeight - 2), juce::Justification::centred);
+}
+
+void ControlGroup::resized()
+{
+    auto area = getLocalBounds();
+    auto header = area.removeFromTop(titleHeight);
+
+    if (headerComponent != nullptr)
+        headerComponent->setBounds(header.removeFromRight(header.getWidth() / 2).reduced(4, 2));
+
+    const auto cellWidth = area.getWidth() / numColumns;
+
+    for (size_t i = 0; i < sliders.size(); ++i)
+    {
+        const auto column = (int) i % numColumns, row = (int) i / numColumns;
+        sliders[i]->setBounds(juce::Rectangle<int>(area.getX() + column * cellWidth, area.getY() + row * sliderHeight, cellWidth, sliderHeight)
+                                  .withTrimmedTop(labelHeight)
+                                  .reduced(2, 0));
+    }
+
+    area.removeFromTop(getNumRows(sliders.size()) * sliderHeight);
+
+    for (size_t i = 0; i < comboBoxes.size(); ++i)
+    {
+        const auto column = (int) i % numColumns, row = (int) i / numColumns;
+        comboBoxes[i]->setBounds(juce::Rectangle<int>(area.getX() + column * cellWidth, area.getY() + row * getComboBoxRowHeight(),
+                                                      cellWidth, getComboBoxRowHeight())
+                                     .withTrimmedTop(hasComboBoxLabels ? labelHeight : 0)
+                                     .reduced(4, 2));
+    }
+}
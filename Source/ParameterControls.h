@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    ParameterControls.h
+    Sliders and combo boxes bound to parameters by polling. The editor
+    calls refresh() once per frame, so automation reaches the controls
+    coalesced to the display rate instead of through a listener callback
+    for every change.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+
+//==============================================================================
+// Rotary slider for one float parameter, with the parameter's own range, skew and text
+class ParameterSlider : public juce::Slider
+{
+public:
+    ParameterSlider(juce::RangedAudioParameter& parameter, const juce::String& label, const juce::String& suffix = {});
+
+    // Message thread. Picks up automation, presets and state restores, returns true if the value moved.
+    bool refresh();
+
+    // Points the slider at another parameter with the same kind of range, e.g. another user band
+    void setParameter(juce::RangedAudioParameter& newParameter);
+
+private:
+    void valueChanged() override;
+    void startedDragging() override;
+    void stoppedDragging() override;
+
+    juce::RangedAudioParameter* parameter;
+    juce::String suffix;
+
+    // normalised, what the slider last showed
+    float lastValue{ -1.0f };
+    bool isDragging{ false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterSlider)
+};
+
+
+//==============================================================================
+// Combo box for one choice parameter
+class ParameterComboBox : public juce::ComboBox
+{
+public:
+    explicit ParameterComboBox(juce::RangedAudioParameter& parameter);
+
+    bool refresh();
+    void setParameter(juce::RangedAudioParameter& newParameter);
+
+private:
+    void selectionChanged();
+
+    juce::RangedAudioParameter* parameter;
+    float lastValue{ -1.0f };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterComboBox)
+};
+
+
+//==============================================================================
+/**
+    A titled group of controls: sliders on a grid numColumns wide, then
+    combo boxes on the same columns below them. Combo boxes given a label
+    get it drawn above them, like the sliders' names. The optional header
+    component sits on the right of the title row.
+*/
+class ControlGroup : public juce::Component
+{
+public:
+    static constexpr int columnWidth = 76, sliderHeight = 92, comboBoxHeight = 28, titleHeight = 22, labelHeight = 14;
+
+    ControlGroup(const juce::String& title, int numColumns);
+
+    ParameterSlider& addSlider(juce::RangedAudioParameter& parameter, const juce::String& label, const juce::String& suffix = {});
+    ParameterComboBox& addComboBox(juce::RangedAudioParameter& parameter, const juce::String& label = {});
+    void setHeaderComponent(juce::Component& component);
+
+    // Polls every control, returns true if any of them moved
+    bool refresh();
+
+    int getPreferredWidth() const noexcept { return numColumns * columnWidth; }
+    int getPreferredHeight() const noexcept;
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+private:
+    int getNumRows(size_t numControls) const noexcept { return ((int) numControls + numColumns - 1) / numColumns; }
+    int getComboBoxRowHeight() const noexcept { return comboBoxHeight + (hasComboBoxLabels ? labelHeight : 0); }
+
+    juce::String title;
+    const int numColumns;
+
+    std::vector<std::unique_ptr<ParameterSlider>> sliders;
+    std::vector<std::unique_ptr<ParameterComboBox>> comboBoxes;
+    bool hasComboBoxLabels{ false };
+    juce::Component* headerComponent{ nullptr };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ControlGroup)
+};
@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+    PerformanceTelemetry.cpp
+
+  ==============================================================================
+*/
+
+#include "PerformanceTelemetry.h"
+
+#if EQ_ENABLE_TELEMETRY
+
+#if JUCE_WINDOWS
+ #include <process.h>
+ #define EQ_GET_PROCESS_ID _getpid
+#else
+ #include <unistd.h>
+ #define EQ_GET_PROCESS_ID getpid
+#endif
+
+//==============================================================================
+int TelemetryData::getHistogramBin(juce::uint64 blockNs) noexcept
+{
+    int bin = 0;
+
+    for (auto us = blockNs / 1000; us > 0 && bin < numHistogramBins - 1; us >>= 1)
+        ++bin;
+
+    return bin;
+}
+
+juce::File getTelemetryDirectory()
+{
+    juce::File sharedMemory("/dev/shm");
+
+    auto parent = sharedMemory.isDirectory() ? sharedMemory
+                                             : juce::File::getSpecialLocation(juce::File::tempDirectory);
+
+    return parent.getChildFile("EQTelemetry");
+}
+
+//==============================================================================
+static std::atomic<juce::uint32> nextInstanceID{ 1 };
+
+PerformanceTelemetry::PerformanceTelemetry()
+{
+    const auto processID = (juce::uint32) EQ_GET_PROCESS_ID();
+    const auto instanceID = nextInstanceID.fetch_add(1);
+
+    auto directory = getTelemetryDirectory();
+    file = directory.getChildFile(juce::String(processID) + "-" + juce::String(instanceID) + ".telemetry");
+
+    // size the file first, then map it and construct the segment in place
+    if (directory.createDirectory() && file.replaceWithData(juce::MemoryBlock(sizeof(TelemetryData), true).getData(), sizeof(TelemetryData)))
+    {
+        mappedFile = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readWrite);
+
+        if (mappedFile->getData() != nullptr && mappedFile->getSize() >= sizeof(TelemetryData))
+            data = new (mappedFile->getData()) TelemetryData();
+        else
+            mappedFile.reset();
+    }
+
+    if (data == nullptr)
+    {
+        localData = std::make_unique<TelemetryData>();
+        data = localData.get();
+    }
+
+    data->processID = processID;
+    data->instanceID = instanceID;
+}
+
+PerformanceTelemetry::~PerformanceTelemetry()
+{
+    if (mappedFile != nullptr)
+    {
+        mappedFile.reset();
+        file.deleteFile();
+    }
+}
+
+void PerformanceTelemetry::prepare(double newSampleRate, int maximumBlockSize, int numChannels) noexcept
+{
+    sampleRate = newSampleRate;
+
+    data->sampleRate.store((juce::uint32) juce::roundToInt(newSampleRate), std::memory_order_relaxed);
+    data->maximumBlockSize.store((juce::uint32) maximumBlockSize, std::memory_order_relaxed);
+    data->numChannels.store((juce::uint32) numChannels, std::memory_order_relaxed);
+
+    resetCounters();
+}
+
+juce::int64 PerformanceTelemetry::beginBlock() noexcept
+{
+    if (data->resetRequested.exchange(0, std::memory_order_relaxed) != 0)
+        resetCounters();
+
+    return juce::Time::getHighResolutionTicks();
+}
+
+void PerformanceTelemetry::endBlock(juce::int64 startTicks, int numSamples) noexcept
+{
+    const auto ticks = juce::Time::getHighResolutionTicks() - startTicks;
+    const auto blockNs = (juce::uint64) juce::jmax(0.0, juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9);
+    const auto budgetNs = sampleRate > 0 ? (juce::uint64) (1.0e9 * numSamples / sampleRate) : 0;
+
+    increment(data->numBlocks);
+    increment(data->numSamples, (juce::uint64) numSamples);
+    increment(data->totalBlockNs, blockNs);
+    increment(data->totalBudgetNs, budgetNs);
+    increment(data->blockHistogram[(size_t) TelemetryData::getHistogramBin(blockNs)]);
+
+    if (blockNs > budgetNs)
+        increment(data->numOverruns);
+
+    data->lastBlockNs.store(blockNs, std::memory_order_relaxed);
+
+    if (blockNs > data->maxBlockNs.load(std::memory_order_relaxed))
+        data->maxBlockNs.store(blockNs, std::memory_order_relaxed);
+}
+
+void PerformanceTelemetry::resetCounters() noexcept
+{
+    for (auto* counter : { &data->numBlocks, &data->numSamples, &data->totalBlockNs, &data->totalBudgetNs,
+                           &data->lastBlockNs, &data->maxBlockNs, &data->numOverruns, &data->numRedesigns,
+                           &data->numDecayingBlocks, &data->numSilentBlocks, &data->numSkippedBlocks })
+        counter->store(0, std::memory_order_relaxed);
+
+    for (auto& bin : data->blockHistogram)
+        bin.store(0, std::memory_order_relaxed);
+}
+
+//==============================================================================
+TelemetryOverlay::TelemetryOverlay(PerformanceTelemetry& telemetryToShow)
+    : telemetry(telemetryToShow)
+{
+    setInterceptsMouseClicks(true, false);
+}
+
+void TelemetryOverlay::visibilityChanged()
+{
+    if (isVisible())
+        startTimerHz(10);
+    else
+        stopTimer();
+}
+
+void TelemetryOverlay::paint(juce::Graphics& g)
+{
+    auto& data = telemetry.getData();
+
+    const auto numBlocks = data.numBlocks.load(std::memory_order_relaxed);
+    const auto totalBlockNs = data.totalBlockNs.load(std::memory_order_relaxed);
+    const auto totalBudgetNs = data.totalBudgetNs.load(std::memory_order_relaxed);
+    const auto numSamples = data.numSamples.load(std::memory_order_relaxed);
+
+    g.fillAll(juce::Colours::black.withAlpha(0.75f));
+    g.setColour(juce::Colours::white);
+    g.setFont(juce::FontOptions(13.0f));
+
+    juce::StringArray lines;
+    lines.add("blocks: " + juce::String((juce::int64) numBlocks)
+              + "   ns/sample: " + juce::String(numSamples > 0 ? (double) totalBlockNs / (double) numSamples : 0.0, 1));
+    lines.add("budget used: " + juce::String(totalBudgetNs > 0 ? 100.0 * (double) totalBlockNs / (double) totalBudgetNs : 0.0, 2) + "%"
+              + "   overruns: " + juce::String((juce::int64) data.numOverruns.load(std::memory_order_relaxed)));
+    lines.add("last block: " + juce::String((double) data.lastBlockNs.load(std::memory_order_relaxed) / 1000.0, 1) + " us"
+              + "   max: " + juce::String((double) data.maxBlockNs.load(std::memory_order_relaxed) / 1000.0, 1) + " us");
+    lines.add("redesigns: " + juce::String((juce::int64) data.numRedesigns.load(std::memory_order_relaxed))
+              + "   decaying-state blocks: " + juce::String((juce::int64) data.numDecayingBlocks.load(std::memory_order_relaxed))
+              + "   silent blocks: " + juce::String((juce::int64) data.numSilentBlocks.load(std::memory_order_relaxed))
+              + "   skipped: " + juce::String((juce::int64) data.numSkippedBlocks.load(std::memory_order_relaxed)));
+
+    auto area = getLocalBounds().reduced(6);
+    auto textArea = area.removeFromTop(lines.size() * 16);
+
+    for (auto& line : lines)
+        g.drawText(line, textArea.removeFromTop(16), juce::Justification::centredLeft);
+
+    // block duration histogram, log scaled counts so the rare slow blocks stay visible
+    area.removeFromTop(4);
+    juce::uint64 largestBin = 1;
+
+    for (auto& bin : data.blockHistogram)
+        largestBin = juce::jmax(largestBin, bin.load(std::memory_order_relaxed));
+
+    const auto barWidth = (float) area.getWidth() / TelemetryData::numHistogramBins;
+
+    for (int i = 0; i < TelemetryData::numHistogramBins; ++i)
+    {
+        const auto count = data.blockHistogram[(size_t) i].load(std::memory_order_relaxed);
+        const auto height = (float) area.getHeight() * (float) (std::log1p((double) count) / std::log1p((double) largestBin));
+
+        g.setColour(juce::Colours::orange);
+        g.fillRect((float) area.getX() + i * barWidth + 1.0f, (float) area.getBottom() - height, barWidth - 2.0f, height);
+    }
+
+    g.setColour(juce::Colours::grey);
+    g.drawText("<1us", area.removeFromBottom(14), juce::Justification::bottomLeft);
+    g.drawText("click to reset", getLocalBounds().reduced(6), juce::Justification::topRight);
+}
+
+void TelemetryOverlay::mouseDown(const juce::MouseEvent&)
+{
+    telemetry.requestReset();
+}
+
+#endif
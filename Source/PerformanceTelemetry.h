@@ -0,0 +1,139 @@
+/*
+  ==============================================================================
+
+    PerformanceTelemetry.h
+    Wait-free processBlock counters, published per instance through a small
+    memory-mapped file so a monitoring tool can read them from outside.
+
+    Everything here compiles out when EQ_ENABLE_TELEMETRY is 0, the default.
+    Every instance creates a shared file, which a crash leaves behind, so
+    only profiling builds and the tools turn it on.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef EQ_ENABLE_TELEMETRY
+ #define EQ_ENABLE_TELEMETRY 0
+#endif
+
+#if EQ_ENABLE_TELEMETRY
+
+//==============================================================================
+/**
+    The shared segment. Fixed layout, written by the audio thread only and read
+    by anyone who maps the file, so every field is a lock-free atomic and no
+    reader ever blocks the writer.
+*/
+struct TelemetryData
+{
+    static constexpr juce::uint32 magicNumber = 0x46545145; // "EQTF"
+    static constexpr juce::uint32 currentVersion = 2;
+
+    // bin 0 is under 1 us, bin n covers [2^(n-1), 2^n) us, the last bin takes everything longer
+    static constexpr int numHistogramBins = 16;
+
+    using Counter = std::atomic<juce::uint64>;
+    static_assert(Counter::is_always_lock_free, "the segment is shared between processes, counters can't hide a lock");
+
+    juce::uint32 magic{ magicNumber }, version{ currentVersion };
+    juce::uint32 processID{ 0 }, instanceID{ 0 };
+
+    std::atomic<juce::uint32> sampleRate{ 0 }, maximumBlockSize{ 0 }, numChannels{ 0 };
+
+    // set by a reader, the audio thread clears the counters at its next block
+    std::atomic<juce::uint32> resetRequested{ 0 };
+
+    Counter numBlocks{ 0 }, numSamples{ 0 };
+    Counter totalBlockNs{ 0 }, totalBudgetNs{ 0 };
+    Counter lastBlockNs{ 0 }, maxBlockNs{ 0 };
+    Counter numOverruns{ 0 };        // blocks that took longer than their share of realtime
+    Counter numRedesigns{ 0 };       // coefficient sets applied on the audio thread
+    Counter numDecayingBlocks{ 0 };  // blocks that left filter state non-zero but below 1e-30, heading for the denormal range.
+                                     // A heuristic from the state magnitude, not a count of subnormal samples.
+    Counter numSilentBlocks{ 0 };    // blocks whose input was below the silence threshold (about -120 dBFS)
+    Counter numSkippedBlocks{ 0 };   // blocks where the filters were asleep and did no work
+
+    std::array<Counter, numHistogramBins> blockHistogram{};
+
+    static int getHistogramBin(juce::uint64 blockNs) noexcept;
+};
+
+// Where the segments live: /dev/shm on Linux, the temp folder elsewhere
+juce::File getTelemetryDirectory();
+
+//==============================================================================
+/**
+    Owns one instance's segment. The audio thread calls the block methods,
+    anything else only reads through getData().
+*/
+class PerformanceTelemetry
+{
+public:
+    PerformanceTelemetry();
+    ~PerformanceTelemetry();
+
+    void prepare(double sampleRate, int maximumBlockSize, int numChannels) noexcept;
+
+    //==============================================================================
+    // Audio thread only
+    juce::int64 beginBlock() noexcept;
+    void endBlock(juce::int64 startTicks, int numSamples) noexcept;
+
+    void addRedesign() noexcept                 { increment(data->numRedesigns); }
+    void addDecayingBlock() noexcept            { increment(data->numDecayingBlocks); }
+    void addSilentBlock() noexcept              { increment(data->numSilentBlocks); }
+    void addSkippedBlock() noexcept             { increment(data->numSkippedBlocks); }
+
+    //==============================================================================
+    const TelemetryData& getData() const noexcept { return *data; }
+
+    // Safe from any thread
+    void requestReset() noexcept { data->resetRequested.store(1, std::memory_order_relaxed); }
+
+private:
+    // single writer, so a load and a store is enough and nothing needs a read-modify-write
+    static void increment(TelemetryData::Counter& counter, juce::uint64 amount = 1) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    void resetCounters() noexcept;
+
+    juce::File file;
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    std::unique_ptr<TelemetryData> localData; // used if the file can't be mapped, so the overlay still works
+    TelemetryData* data{ nullptr };
+
+    double sampleRate{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PerformanceTelemetry)
+};
+
+
+//==============================================================================
+// Optional editor overlay showing the same counters
+class TelemetryOverlay : public juce::Component,
+                         private juce::Timer
+{
+public:
+    explicit TelemetryOverlay(PerformanceTelemetry& telemetry);
+
+    void paint(juce::Graphics& g) override;
+    void mouseDown(const juce::MouseEvent& event) override;
+
+    // only ticks while it is shown
+    void visibilityChanged() override;
+
+private:
+    void timerCallback() override { repaint(); }
+
+    PerformanceTelemetry& telemetry;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TelemetryOverlay)
+};
+
+#endif
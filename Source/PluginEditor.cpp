@@ -9,13 +9,86 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+//==============================================================================
+static juce::RangedAudioParameter& getParameter(juce::AudioProcessorValueTreeState& parameterManager, const juce::String& parameterID)
+{
+    auto* parameter = parameterManager.getParameter(parameterID);
+    jassert(parameter != nullptr);
+    return *parameter;
+}
+
 //==============================================================================
 _3BandEQTutorialAudioProcessorEditor::_3BandEQTutorialAudioProcessorEditor (_3BandEQTutorialAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p)
 {
+    auto& parameters = audioProcessor.parameterManager;
+
+    lowCutGroup.addSlider(getParameter(parameters, "LowCut Freq"), "Freq", " Hz");
+    lowCutGroup.addComboBox(getParameter(parameters, "LowCut Slope"));
+
+    peakGroup.addSlider(getParameter(parameters, "Peak Freq"), "Freq", " Hz");
+    peakGroup.addSlider(getParameter(parameters, "Peak Gain"), "Gain", " dB");
+    peakGroup.addSlider(getParameter(parameters, "Quality"), "Q");
+
+    highCutGroup.addSlider(getParameter(parameters, "HiCut Freq"), "Freq", " Hz");
+    highCutGroup.addComboBox(getParameter(parameters, "HiCut Slope"));
+
+    dynamicGroup.addSlider(getParameter(parameters, "Dynamic Threshold"), "Threshold", " dB");
+    dynamicGroup.addSlider(getParameter(parameters, "Dynamic Ratio"), "Ratio", ":1");
+    dynamicGroup.addSlider(getParameter(parameters, "Dynamic Attack"), "Attack", " ms");
+    dynamicGroup.addSlider(getParameter(parameters, "Dynamic Release"), "Release", " ms");
+    dynamicGroup.addComboBox(getParameter(parameters, "Dynamic Mode"));
+
+    for (auto* parameterID : { "Phase Mode", "FIR Length", "Oversampling", "Control Rate", "Filter Topology" })
+        processingGroup.addComboBox(getParameter(parameters, parameterID), parameterID);
+
+    bandGroups = { &lowCutGroup, &peakGroup, &highCutGroup, &dynamicGroup };
+
+   #if EQ_NUM_USER_BANDS > 0
+    userBandFrequency = &userBandGroup.addSlider(getParameter(parameters, "Band 1 Freq"), "Freq", " Hz");
+    userBandGain = &userBandGroup.addSlider(getParameter(parameters, "Band 1 Gain"), "Gain", " dB");
+    userBandQuality = &userBandGroup.addSlider(getParameter(parameters, "Band 1 Q"), "Q");
+    userBandType = &userBandGroup.addComboBox(getParameter(parameters, "Band 1 Type"));
+
+    for (int band = 0; band < EQ_NUM_USER_BANDS; ++band)
+        userBandSelector.addItem("Band " + juce::String(band + 1), band + 1);
+
+    userBandSelector.setSelectedItemIndex(0, juce::dontSendNotification);
+    userBandSelector.onChange = [this] { showUserBand(userBandSelector.getSelectedItemIndex()); };
+    userBandGroup.setHeaderComponent(userBandSelector);
+
+    bandGroups.push_back(&userBandGroup);
+   #endif
+
+    addAndMakeVisible(responseGrid);
+    addAndMakeVisible(spectrumDisplay);
+    addAndMakeVisible(responseCurveDisplay);
+
+    for (auto* group : bandGroups)
+        addAndMakeVisible(*group);
+
+    addAndMakeVisible(processingGroup);
+
+   #if EQ_ENABLE_TELEMETRY
+    addAndMakeVisible(telemetryButton);
+    addChildComponent(telemetryOverlay);
+
+    telemetryButton.onClick = [this] { telemetryOverlay.setVisible(telemetryButton.getToggleState()); };
+   #endif
+
+    setOpaque(true);
+
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (400, 300);
+    auto width = margin, bandRowHeight = 0;
+
+    for (auto* group : bandGroups)
+    {
+        width += group->getPreferredWidth() + margin;
+        bandRowHeight = juce::jmax(bandRowHeight, group->getPreferredHeight());
+    }
+
+    setSize (width, toolbarHeight + spectrumHeight + bandRowHeight + processingGroup.getPreferredHeight() + 3 * margin);
 }
 
 _3BandEQTutorialAudioProcessorEditor::~_3BandEQTutorialAudioProcessorEditor()
@@ -27,14 +100,71 @@ void _3BandEQTutorialAudioProcessorEditor::paint (juce::Graphics& g)
 {
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-
-    g.setColour (juce::Colours::white);
-    g.setFont (juce::FontOptions (15.0f));
-    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
 }
 
 void _3BandEQTutorialAudioProcessorEditor::resized()
 {
     // This is generally where you'll want to lay out the positions of any
     // subcomponents in your editor..
+    auto area = getLocalBounds();
+    responseGrid.setBounds(area.removeFromTop(spectrumHeight));
+    spectrumDisplay.setBounds(responseGrid.getBounds());
+    responseCurveDisplay.setBounds(responseGrid.getBounds());
+    auto toolbar = area.removeFromTop(toolbarHeight);
+
+    auto controls = area.reduced(margin, 0);
+    processingGroup.setBounds(controls.removeFromBottom(processingGroup.getPreferredHeight() + margin).withTrimmedBottom(margin));
+
+    auto bandRow = controls.withTrimmedTop(margin).withTrimmedBottom(margin);
+
+    for (auto* group : bandGroups)
+    {
+        group->setBounds(bandRow.removeFromLeft(group->getPreferredWidth()));
+        bandRow.removeFromLeft(margin);
+    }
+
+   #if EQ_ENABLE_TELEMETRY
+    telemetryButton.setBounds(toolbar.reduced(4));
+    telemetryOverlay.setBounds(area.removeFromBottom(juce::jmin(area.getHeight(), 140)));
+   #else
+    juce::ignoreUnused(toolbar);
+   #endif
+}
+
+void _3BandEQTutorialAudioProcessorEditor::refresh()
+{
+    // the attachment follows the monitor, which can be 120 Hz or more, so skip frames that come too soon.
+    // The millisecond off the interval keeps a 60 Hz monitor's jitter from dropping every other frame.
+    const auto now = juce::Time::getMillisecondCounterHiRes();
+
+    if (now - lastRefreshMs < 1000.0 / maxRefreshHz - 1.0)
+        return;
+
+    lastRefreshMs = now;
+
+    // one poll per frame coalesces however many parameter changes came in since the last one
+    for (auto* group : bandGroups)
+        group->refresh();
+
+    processingGroup.refresh();
+    responseCurveDisplay.refresh();
+
+    if (++frameCount % 2 == 0)
+        spectrumDisplay.refresh();
+}
+
+#if EQ_NUM_USER_BANDS > 0
+void _3BandEQTutorialAudioProcessorEditor::showUserBand(int band)
+{
+    if (band < 0)
+        return;
+
+    auto& parameters = audioProcessor.parameterManager;
+    const auto prefix = "Band " + juce::String(band + 1) + " ";
+
+    userBandFrequency->setParameter(getParameter(parameters, prefix + "Freq"));
+    userBandGain->setParameter(getParameter(parameters, prefix + "Gain"));
+    userBandQuality->setParameter(getParameter(parameters, prefix + "Q"));
+    userBandType->setParameter(getParameter(parameters, prefix + "Type"));
 }
+#endif
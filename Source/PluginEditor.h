@@ -10,9 +10,18 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "ResponseCurve.h"
+#include "ParameterControls.h"
 
 //==============================================================================
 /**
+    Band controls over the spectrum and response curve.
+
+    Nothing here listens to parameters or runs its own timer: one
+    VBlankAttachment, capped at maxRefreshHz, polls the controls and the
+    displays once per frame, and each repaints only what actually moved.
+    The grid is a cached image, so an editor with nothing moving costs a
+    handful of comparisons per frame.
 */
 class _3BandEQTutorialAudioProcessorEditor  : public juce::AudioProcessorEditor
 {
@@ -25,9 +34,50 @@ public:
     void resized() override;
 
 private:
+    static constexpr int toolbarHeight = 28, spectrumHeight = 240, margin = 6;
+
+    // whatever the monitor runs at, the controls and curve update at most this often and the spectrum at half of it
+    static constexpr double maxRefreshHz = 60.0;
+
+    void refresh();
+
+   #if EQ_NUM_USER_BANDS > 0
+    void showUserBand(int band);
+   #endif
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     _3BandEQTutorialAudioProcessor& audioProcessor;
 
+    ResponseGrid responseGrid;
+    SpectrumDisplay spectrumDisplay{ audioProcessor.getAnalyser() };
+    ResponseCurveDisplay responseCurveDisplay{ audioProcessor };
+
+    ControlGroup lowCutGroup{ "Low Cut", 1 }, peakGroup{ "Peak", 3 }, highCutGroup{ "High Cut", 1 }, dynamicGroup{ "Dynamic", 4 };
+    ControlGroup processingGroup{ "Processing", 5 };
+
+   #if EQ_NUM_USER_BANDS > 0
+    // one band at a time, the selector points the controls at another band's parameters
+    ControlGroup userBandGroup{ "User Bands", 3 };
+    juce::ComboBox userBandSelector;
+    ParameterSlider* userBandFrequency{ nullptr };
+    ParameterSlider* userBandGain{ nullptr };
+    ParameterSlider* userBandQuality{ nullptr };
+    ParameterComboBox* userBandType{ nullptr };
+   #endif
+
+    std::vector<ControlGroup*> bandGroups;
+
+   #if EQ_ENABLE_TELEMETRY
+    juce::ToggleButton telemetryButton{ "Show performance stats" };
+    TelemetryOverlay telemetryOverlay{ audioProcessor.getTelemetry() };
+   #endif
+
+    double lastRefreshMs{ 0 };
+    juce::uint32 frameCount{ 0 };
+
+    // last, so it never fires into a half constructed or half destroyed editor
+    juce::VBlankAttachment vBlankAttachment{ this, [this] { refresh(); } };
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (_3BandEQTutorialAudioProcessorEditor)
 };
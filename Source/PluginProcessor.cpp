@@ -16,16 +16,25 @@ _3BandEQTutorialAudioProcessor::_3BandEQTutorialAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
                        )
 #endif
 {
+    coefficientDesigner.setListener(&linearPhaseEngine);
+
+    // the structural settings are polled on the message thread, so nothing ever gets posted from the audio thread
+    startTimer(structuralPollIntervalMs);
+
+    presetBank.loadFromFile(getDefaultPresetBankFile());
 }
 
 _3BandEQTutorialAudioProcessor::~_3BandEQTutorialAudioProcessor()
 {
+    stopTimer();
+    coefficientDesigner.setListener(nullptr);
 }
 
 //==============================================================================
@@ -63,31 +72,91 @@ bool _3BandEQTutorialAudioProcessor::isMidiEffect() const
 
 double _3BandEQTutorialAudioProcessor::getTailLengthSeconds() const
 {
+    // worked out from the running coefficients whenever they're applied, see computeTailSamples()
+    if (getSampleRate() > 0)
+       #if EQ_NUM_USER_BANDS > 0
+        return (tailSamples.load(std::memory_order_relaxed) + userBandTailSamples.load(std::memory_order_relaxed)) / getSampleRate();
+       #else
+        return tailSamples.load(std::memory_order_relaxed) / getSampleRate();
+       #endif
+
     return 0.0;
 }
 
 int _3BandEQTutorialAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    return juce::jmax(1, presetBank.getNumPresets());   // NB: some hosts don't cope very well if you tell them there are 0 programs,
+                                                        // so this should be at least 1, even if you're not really implementing programs.
 }
 
 int _3BandEQTutorialAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram;
 }
 
 void _3BandEQTutorialAudioProcessor::setCurrentProgram (int index)
 {
+    if (!juce::isPositiveAndBelow(index, presetBank.getNumPresets()))
+        return;
+
+    currentProgram = index;
+
+    // parameters first, so the designer, the smoother and the editor already agree with the program
+    // by the time the audio thread switches to it. They're written one at a time, so the audio thread
+    // keeps its current settings until the sequence is even again, and the designer holds off meanwhile.
+    programWriteSequence.fetch_add(1);
+    coefficientDesigner.writeProgram(presetBank.getSettings(index));
+
+    // the preset is designed here the first time it's selected, the audio thread picks it up at its next block.
+    // Before prepareToPlay there is no set yet, and prepare designs from the parameters anyway.
+    {
+        const juce::ScopedLock prepareScope(prepareLock);
+
+        if (auto* programSet = presetBank.getDesignedSet(index))
+            pendingProgramSet.store(programSet);
+    }
+
+    programWriteSequence.fetch_add(1);
 }
 
 const juce::String _3BandEQTutorialAudioProcessor::getProgramName (int index)
 {
-    return {};
+    return presetBank.getName(index);
 }
 
 void _3BandEQTutorialAudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
+    // bank presets are read only, they may well be in a mapped file
+    juce::ignoreUnused(index, newName);
+}
+
+bool _3BandEQTutorialAudioProcessor::loadPresetBank(const juce::File& file)
+{
+    // the audio thread may be about to use one of the old bank's sets, so the swap happens with processing suspended
+    suspendProcessing(true);
+    pendingProgramSet.store(nullptr);
+
+    const auto loaded = presetBank.loadFromFile(file);
+
+    if (loaded)
+    {
+        currentProgram = 0;
+
+        if (getSampleRate() > 0)
+            presetBank.prepare(parameterManager, getSampleRate(), oversamplingFactor);
+    }
+
+    suspendProcessing(false);
+
+    if (loaded)
+        updateHostDisplay(ChangeDetails().withProgramChanged(true));
+
+    return loaded;
+}
+
+juce::File _3BandEQTutorialAudioProcessor::getDefaultPresetBankFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory).getChildFile("3BandEQ").getChildFile("Presets.eqbank");
 }
 
 //==============================================================================
@@ -96,34 +165,115 @@ void _3BandEQTutorialAudioProcessor::prepareToPlay (double sampleRate, int sampl
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
 
-    //configuring AudioChains
+    // the timer re-prepares from the message thread, hosts may prepare from another one
+    const juce::ScopedLock prepareScope(prepareLock);
+
+    //configuring the filter engine
     juce::dsp::ProcessSpec spec;
 
     spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
+    spec.numChannels = (juce::uint32) getMainBusNumOutputChannels();
     spec.sampleRate = sampleRate;
 
-    leftChain.prepare(spec);
-    rightChain.prepare(spec); 
+    // the structural settings are applied here, they change latency and need allocating.
+    // The topology is fixed per prepare, switching it means re-preparing like the others.
+    const auto topology = getSelectedTopology();
+    linearPhaseActive = isLinearPhaseSelected();
+    oversamplingFactor = getSelectedOversamplingFactor();
+
+    // the FIR is built from the oversampled designs too, so it gets the uncramped response,
+    // but only the IIR chain needs the resampling itself. Without it the oversampled engines get no channels.
+    const auto useOversampler = oversamplingFactor > 1 && !linearPhaseActive;
+    auto oversampledSpec = spec;
+    oversampledSpec.sampleRate *= oversamplingFactor;
+    oversampledSpec.maximumBlockSize = useOversampler ? spec.maximumBlockSize * (juce::uint32) oversamplingFactor : 0;
+    oversampledSpec.numChannels = useOversampler ? spec.numChannels : 0;
+
+    // every engine, the program fade's copies included, carves its coefficients, state and scratch space from the
+    // one instance arena, sized here for all of them
+    filterArena.reset(2 * SIMDFilterEngine::getArenaBytes(spec) + 2 * SIMDFilterEngine::getArenaBytes(oversampledSpec)
+                     #if EQ_NUM_USER_BANDS > 0
+                      + 2 * ParallelFilterEngine::getArenaBytes(spec)
+                     #endif
+                      );
 
-    auto chainSettings = getChainSettings(parameterManager);
-    auto peakCoefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, chainSettings.peakFreq, chainSettings.peakQuality,
-        juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels)
-    );
-    
+    filterEngine.prepare(spec, topology, &filterArena);
+    oversampledEngine.prepare(oversampledSpec, topology, &filterArena);
 
-    *leftChain.get<ChainPositions::Peak>().coefficients = *peakCoefficients;
-    *rightChain.get<ChainPositions::Peak>().coefficients = *peakCoefficients;
+    // a program change crossfades from a copy of the old filters, which need their own engines and scratch space
+    fadeEngine.prepare(spec, topology, &filterArena);
+    fadeOversampledEngine.prepare(oversampledSpec, topology, &filterArena);
+    fadeBuffer.setSize((int) spec.numChannels, samplesPerBlock);
 
-    
+    if (linearPhaseActive)
+        linearPhaseEngine.prepare(spec, getSelectedFIRLength());
+    else
+        linearPhaseEngine.release();
 
+    if (useOversampler)
+    {
+        oversampler = std::make_unique<juce::dsp::Oversampling<float>>(spec.numChannels, (size_t) std::log2(oversamplingFactor),
+                                                                       juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR,
+                                                                       true, true);
+        oversampler->initProcessing((size_t) samplesPerBlock);
+        oversampledFadeBuffer.setSize((int) spec.numChannels, samplesPerBlock * oversamplingFactor);
+    }
+    else
+    {
+        oversampler.reset();
+        oversampledFadeBuffer.setSize(0, 0);
+    }
+
+    // sample rate may have changed, so every band gets redesigned here.
+    // Publishing also designs the first linear-phase kernel, which reset() switches to without a fade.
+    coefficientDesigner.prepare(sampleRate, oversamplingFactor);
+    coefficientDesigner.pullLatest();
+    applyCoefficients(coefficientDesigner.getLatest());
+    linearPhaseEngine.reset();
+
+   #if EQ_NUM_USER_BANDS > 0
+    userBandEngine.prepare(spec, &filterArena);
+    userBandFadeEngine.prepare(spec, &filterArena);
+    userBandDesigner.prepare(sampleRate);
+    userBandDesigner.pullLatest();
+    applyUserBands(userBandDesigner.getLatest());
+    userBandFadeLength = userBandFadePosition = 0;
+   #endif
+
+    setLatencySamples(getProcessingLatency());
+
+    // with "Control Rate" on the IIR chain follows the smoother instead, from the same parameters
+    smoothingActive = isSmoothingSelected();
+    designedSetPending = false;
+    coefficientSmoother.prepare(sampleRate, getChainSettings(chainParameters), smoothedCoefficients, oversamplingFactor);
+    nextBlockPosition = 0;
+    silentSamples = 0;
+    sleeping = false;
+
+    analyser.prepare(sampleRate);
 
+    preparedBlockSize = samplesPerBlock;
+    dynamicPeak.prepare(sampleRate, samplesPerBlock);
+    oversampledModulation.assign(oversampler != nullptr ? (size_t) (samplesPerBlock * oversamplingFactor) : 0, 0.0f);
+
+    // any pending program points into sets that are about to be redesigned
+    pendingProgramSet.store(nullptr);
+    presetBank.prepare(parameterManager, sampleRate, oversamplingFactor);
+    programFadeLength = programFadePosition = juce::roundToInt(programFadeSeconds * sampleRate);
+
+   #if EQ_ENABLE_TELEMETRY
+    telemetry.prepare(sampleRate, samplesPerBlock, (int) spec.numChannels);
+   #endif
+
+    prepared = true;
 }
 
 void _3BandEQTutorialAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    const juce::ScopedLock prepareScope(prepareLock);
+    prepared = false;
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -133,12 +283,10 @@ bool _3BandEQTutorialAudioProcessor::isBusesLayoutSupported (const BusesLayout&
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // The filter engine is sized from the real channel count in prepareToPlay,
+    // so any layout works as long as there is something to process
+    // (mono, stereo, 5.1, 7.1.4, ambisonics...).
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -147,6 +295,8 @@ bool _3BandEQTutorialAudioProcessor::isBusesLayoutSupported (const BusesLayout&
         return false;
    #endif
 
+    // the sidechain is averaged down to one detector signal, so it can have any layout or be disabled
+
     return true;
   #endif
 }
@@ -155,6 +305,15 @@ bool _3BandEQTutorialAudioProcessor::isBusesLayoutSupported (const BusesLayout&
 void _3BandEQTutorialAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+
+    // with EQ_REALTIME_SAFETY_CHECKS the tools trap any allocation, lock or blocking call from here on.
+    // Offline renders design in line on purpose, so they aren't marked.
+    const RealtimeSafety::ScopedRealtimeContext realtimeContext(!isNonRealtime());
+
+   #if EQ_ENABLE_TELEMETRY
+    const auto telemetryStart = telemetry.beginBlock();
+   #endif
+
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -167,119 +326,495 @@ void _3BandEQTutorialAudioProcessor::processBlock (juce::AudioBuffer<float>& buf
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    auto chainSettings = getChainSettings(parameterManager);
-    auto peakCoefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(), chainSettings.peakFreq, chainSettings.peakQuality,
-        juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels)
-    );
-    *leftChain.get<ChainPositions::Peak>().coefficients = *peakCoefficients;
-    *rightChain.get<ChainPositions::Peak>().coefficients = *peakCoefficients;
-
-    auto cutCoeffecients = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, getSampleRate(),
-        (chainSettings.lowCutSlope + 1) * 2);
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
-
-    // bypass audio chains
-    leftLowCut.setBypassed<0>(true);
-    leftLowCut.setBypassed<1>(true);
-    leftLowCut.setBypassed<2>(true);
-    leftLowCut.setBypassed<3>(true);
-    rightLowCut.setBypassed<0>(true);
-    rightLowCut.setBypassed<1>(true);
-    rightLowCut.setBypassed<2>(true);
-    rightLowCut.setBypassed<3>(true);
-
-    // switch statement for easier acess (LEFT)
-    switch (chainSettings.lowCutSlope)
+    const auto numSamples = buffer.getNumSamples();
+    const auto blockPosition = getBlockPosition();
+    nextBlockPosition = blockPosition + numSamples;
+
+    // everything sized in prepareToPlay holds preparedBlockSize samples, so a host sending more than it prepared
+    // for gets its block run in pieces, each at its own place on the control interval grid
+    const auto chunkSize = preparedBlockSize > 0 ? preparedBlockSize : numSamples;
+    juce::dsp::AudioBlock<float> block(buffer);
+
+    for (int start = 0; start < numSamples; start += chunkSize)
+        processChunk(block.getSubBlock((size_t) start, (size_t) juce::jmin(chunkSize, numSamples - start)), blockPosition + start);
+
+   #if EQ_ENABLE_TELEMETRY
+    if (sleeping)
+        telemetry.addSkippedBlock();
+    else if (filterEngine.hasDecayingState())
+        telemetry.addDecayingBlock();
+
+    telemetry.endBlock(telemetryStart, numSamples);
+   #endif
+}
+
+void _3BandEQTutorialAudioProcessor::processChunk(const juce::dsp::AudioBlock<float>& block, juce::int64 blockPosition)
+{
+    // channels are processed together in the lanes of SIMD registers, a group at a time
+    auto mainBlock = block.getSubsetChannelBlock(0, (size_t) getMainBusNumInputChannels());
+
+    analyser.pushPre(mainBlock);
+    updateSleepState(mainBlock);
+
+    const auto controlInterval = getControlInterval();
+
+    if (isSmoothingSelected() != smoothingActive)
     {
-    case SLOPE_12:
-        *leftLowCut.get<0>().coefficients = *cutCoeffecients[0];
-        leftLowCut.setBypassed<0>(false);
-        break;
-    case SLOPE_24:
-        *leftLowCut.get<0>().coefficients = *cutCoeffecients[0];
-        leftLowCut.setBypassed<0>(false);
-        *leftLowCut.get<1>().coefficients = *cutCoeffecients[1];
-        leftLowCut.setBypassed<1>(false);
-        break;
-    case SLOPE_36:
-        *leftLowCut.get<0>().coefficients = *cutCoeffecients[0];
-        leftLowCut.setBypassed<0>(false);
-        *leftLowCut.get<1>().coefficients = *cutCoeffecients[1];
-        leftLowCut.setBypassed<1>(false);
-        *leftLowCut.get<2>().coefficients = *cutCoeffecients[2];
-        leftLowCut.setBypassed<2>(false);
-        break;
-    case SLOPE_48:
-        *leftLowCut.get<0>().coefficients = *cutCoeffecients[0];
-        leftLowCut.setBypassed<0>(false);
-        *leftLowCut.get<1>().coefficients = *cutCoeffecients[1];
-        leftLowCut.setBypassed<1>(false);
-        *leftLowCut.get<2>().coefficients = *cutCoeffecients[2];
-        leftLowCut.setBypassed<2>(false);
-        *leftLowCut.get<3>().coefficients = *cutCoeffecients[3];
-        leftLowCut.setBypassed<3>(false);
-        break;
+        // either way the switch lands at the next grid point: the smoother designs its starting set there,
+        // or the designer's newest set takes over from the ramp
+        smoothingActive = !smoothingActive;
+
+        if (smoothingActive)
+            coefficientSmoother.startFrom(getChainSettings(chainParameters));
+        else
+            designedSetPending = true;
     }
 
+    // a program change lands here, replacing whatever the smoother had. Only settings read whole get through.
+    ChainSettings chainSettings;
+    const CoefficientSet* programSet = nullptr;
 
-    // switch statement for easier acess
-    switch (chainSettings.lowCutSlope)
+    if (readChainSettings(chainSettings, programSet))
     {
-    case SLOPE_12:
-        *rightLowCut.get<0>().coefficients = *cutCoeffecients[0];
-        rightLowCut.setBypassed<0>(false);
-        break;
-
-    case SLOPE_24:
-        *rightLowCut.get<0>().coefficients = *cutCoeffecients[0];
-        rightLowCut.setBypassed<0>(false);
-        *rightLowCut.get<1>().coefficients = *cutCoeffecients[1];
-        rightLowCut.setBypassed<1>(false);
-        break;
-
-    case SLOPE_36:
-        *rightLowCut.get<0>().coefficients = *cutCoeffecients[0];
-       rightLowCut.setBypassed<0>(false);
-        *rightLowCut.get<1>().coefficients = *cutCoeffecients[1];
-        rightLowCut.setBypassed<1>(false);
-        *rightLowCut.get<2>().coefficients = *cutCoeffecients[2];
-        rightLowCut.setBypassed<2>(false);
-        break;
-
-    case SLOPE_48:
-        *rightLowCut.get<0>().coefficients = *cutCoeffecients[0];
-        rightLowCut.setBypassed<0>(false);
-        *rightLowCut.get<1>().coefficients = *cutCoeffecients[1];
-        rightLowCut.setBypassed<1>(false);
-        *rightLowCut.get<2>().coefficients = *cutCoeffecients[2];
-        rightLowCut.setBypassed<2>(false);
-        *rightLowCut.get<3>().coefficients = *cutCoeffecients[3];
-        rightLowCut.setBypassed<3>(false);
-        break;
+        if (programSet != nullptr)
+            startProgramChange(*programSet, chainSettings);
+        else if (smoothingActive)
+            coefficientSmoother.setTargets(chainSettings);
     }
 
+    // Offline renders can run far ahead of the designer thread's polling, so they design in line to keep bounces
+    // deterministic. Realtime the designer thread has usually published by the next block.
+    if (isNonRealtime())
+        coefficientDesigner.designPendingChanges();
 
+    // without smoothing the IIR chain takes the designer's sets too, applied at the next grid point
+    if (!linearPhaseActive && !smoothingActive && coefficientDesigner.pullLatest())
+        designedSetPending = true;
 
-    // This is the place where you'd normally do the guts of your plugin's
-    // audio processing...
-    // Make sure to reset the state if your inner loop is processing
-    // the samples and the outer loop is handling the channels.
-    // Alternatively, you can process the samples with the channels
-    // interleaved by keeping the same state.
-    juce::dsp::AudioBlock<float> block(buffer);
+    const auto* peakModulation = processDynamics(block);
+
+    if (linearPhaseActive)
+    {
+        // the kernels are built from the designer's sets and crossfade in on their own.
+        // Switching back to minimum phase re-prepares, which designs the IIR chain from the parameters.
+        if (sleeping)
+            mainBlock.clear();
+        else
+            linearPhaseEngine.process(mainBlock);
+    }
+    else
+    {
+        processControlIntervals(mainBlock, controlInterval, blockPosition, peakModulation);
+    }
+
+   #if EQ_NUM_USER_BANDS > 0
+    if (isNonRealtime())
+        userBandDesigner.designPendingChanges();
+
+    if (userBandDesigner.pullLatest())
+        applyUserBands(userBandDesigner.getLatest());
+
+    if (!sleeping)
+        processUserBands(mainBlock);
+   #endif
+
+    analyser.pushPost(mainBlock);
+}
+
+const float* _3BandEQTutorialAudioProcessor::processDynamics(const juce::dsp::AudioBlock<float>& block) noexcept
+{
+    // the FIR can't follow a gain that moves every sample, so linear phase stays static
+    if (sleeping || linearPhaseActive)
+        return nullptr;
+
+    const auto mode = getSelectedDynamicMode();
+
+    if (mode == DYNAMIC_OFF)
+    {
+        if (!dynamicPeak.isModulating())
+            return nullptr;
+
+        dynamicPeak.processBypassed((int) block.getNumSamples());
+        return dynamicPeak.getModulation();
+    }
+
+    dynamicPeak.setParameters(dynamicThreshold->load(), dynamicRatio->load(), dynamicAttack->load(), dynamicRelease->load());
+
+    // the detector listens to the input before the EQ, or to the sidechain when it's connected
+    auto* sidechain = getBus(true, 1);
+
+    if (mode == DYNAMIC_SIDECHAIN && sidechain != nullptr && sidechain->isEnabled() && sidechain->getNumberOfChannels() > 0)
+        dynamicPeak.process(block.getSubsetChannelBlock((size_t) sidechain->getChannelIndexInProcessBlockBuffer(0),
+                                                        (size_t) sidechain->getNumberOfChannels()));
+    else
+        dynamicPeak.process(block.getSubsetChannelBlock(0, (size_t) getMainBusNumInputChannels()));
+
+    return dynamicPeak.getModulation();
+}
+
+void _3BandEQTutorialAudioProcessor::processControlIntervals(juce::dsp::AudioBlock<float>& block, int controlInterval,
+                                                             juce::int64 blockPosition, const float* peakModulation)
+{
+    // coefficients only move on a grid of absolute samples, so where a change lands doesn't depend on where the
+    // host's blocks start. The block is only split while a set is waiting for its grid point or a ramp is running,
+    // otherwise it goes through in one piece. A block starting between two grid points finishes the previous
+    // interval on its coefficients first, and the filter state simply carries on across segments.
+    const auto numSamples = (int) block.getNumSamples();
+    auto nextGridPoint = (int) ((controlInterval - blockPosition % controlInterval) % controlInterval);
+
+    for (int start = 0; start < numSamples;)
+    {
+        auto end = numSamples;
+
+        if (smoothingActive ? coefficientSmoother.isSmoothing() : designedSetPending)
+        {
+            if (start == nextGridPoint)
+            {
+                if (!smoothingActive)
+                {
+                    applyCoefficients(coefficientDesigner.getLatest());
+                    designedSetPending = false;
+                }
+                // a whole interval at a time, whatever part of it this block holds, so ramps take as long at any block size
+                else if (coefficientSmoother.advance(controlInterval, smoothedCoefficients))
+                {
+                    applyCoefficients(smoothedCoefficients);
+                }
+
+                nextGridPoint += controlInterval;
+                continue;
+            }
+
+            end = juce::jmin(nextGridPoint, numSamples);
+        }
+
+        // asleep, the coefficients still follow the ramp so waking up lands on the right ones
+        if (!sleeping)
+            processIIR(block.getSubBlock((size_t) start, (size_t) (end - start)), peakModulation != nullptr ? peakModulation + start : nullptr);
+
+        start = end;
+    }
+
+    if (sleeping)
+        block.clear();
+}
+
+void _3BandEQTutorialAudioProcessor::processIIR(const juce::dsp::AudioBlock<float>& block, const float* peakModulation) noexcept
+{
+    const auto fading = isProgramFading();
+
+    // the dynamic gain goes to whichever engine runs the peak
+    const auto* baseModulation = oversampler == nullptr ? peakModulation : nullptr;
+
+    if (fading)
+        processCrossfaded(filterEngine, fadeEngine, block, fadeBuffer, 1, baseModulation);
+    else
+        filterEngine.process(block, baseModulation);
+
+    if (oversampler != nullptr)
+    {
+        auto outputBlock = block;
+        auto oversampledBlock = oversampler->processSamplesUp(block);
+        const float* oversampledPeakModulation = nullptr;
+
+        if (peakModulation != nullptr)
+        {
+            for (size_t i = 0; i < block.getNumSamples(); ++i)
+                std::fill_n(oversampledModulation.data() + i * (size_t) oversamplingFactor, oversamplingFactor, peakModulation[i]);
+
+            oversampledPeakModulation = oversampledModulation.data();
+        }
+
+        if (fading)
+            processCrossfaded(oversampledEngine, fadeOversampledEngine, oversampledBlock, oversampledFadeBuffer, oversamplingFactor,
+                              oversampledPeakModulation);
+        else
+            oversampledEngine.process(oversampledBlock, oversampledPeakModulation);
+
+        oversampler->processSamplesDown(outputBlock);
+    }
+
+    if (fading)
+        programFadePosition += (int) block.getNumSamples();
+}
+
+bool _3BandEQTutorialAudioProcessor::readChainSettings(ChainSettings& chainSettings, const CoefficientSet*& programSet) noexcept
+{
+    // the reading side of the seqlock: while setCurrentProgram is writing a program, or if it started
+    // while the parameters were being read, the block carries on with the settings it already had
+    const auto sequence = programWriteSequence.load();
+
+    if ((sequence & 1) != 0)
+        return false;
+
+    chainSettings = getChainSettings(chainParameters);
+    programSet = pendingProgramSet.load();
+
+    if (programWriteSequence.load() != sequence)
+        return false;
+
+    // a newer program may have been published since, it's picked up whole next block
+    return programSet == nullptr || pendingProgramSet.compare_exchange_strong(programSet, nullptr);
+}
+
+void _3BandEQTutorialAudioProcessor::startProgramChange(const CoefficientSet& programSet, const ChainSettings& programSettings) noexcept
+{
+    // linear phase kernels crossfade on their own once the designer catches up with the parameters,
+    // and asleep there is no filter state worth fading from
+    if (!linearPhaseActive && !sleeping)
+    {
+        fadeEngine.copyFrom(filterEngine);
+
+        if (oversampler != nullptr)
+            fadeOversampledEngine.copyFrom(oversampledEngine);
+
+        programFadePosition = 0;
+    }
+
+    // the parameters already hold the program, so the smoother has nothing left to ramp or design. Anything the
+    // designer published before the program was written is dropped, everything it publishes after is the program.
+    coefficientDesigner.pullLatest();
+    designedSetPending = false;
+    coefficientSmoother.jumpTo(programSettings);
+    smoothedCoefficients = programSet;
+    applyCoefficients(programSet);
+}
+
+void _3BandEQTutorialAudioProcessor::processCrossfaded(SIMDFilterEngine& engine, SIMDFilterEngine& outgoingEngine,
+                                                       const juce::dsp::AudioBlock<float>& block,
+                                                       juce::AudioBuffer<float>& scratch, int rateFactor, const float* peakModulation) noexcept
+{
+    const auto numSamples = block.getNumSamples();
+    const auto numChannels = block.getNumChannels();
+
+    // the outgoing engine carries on with the old coefficients and state on a copy of the input
+    auto outgoingBlock = juce::dsp::AudioBlock<float>(scratch).getSubsetChannelBlock(0, numChannels).getSubBlock(0, numSamples);
+    outgoingBlock.copyFrom(block);
+
+    engine.process(block, peakModulation);
+    outgoingEngine.process(outgoingBlock, peakModulation);
+
+    // equal power, the gains rotated along the quarter circle a sample at a time, so the trig is only done per block.
+    // Past the end of the fade the new filters play on their own and there is nothing left to mix.
+    const auto fadeStart = programFadePosition * rateFactor;
+    const auto fadeLength = programFadeLength * rateFactor;
+    const auto numFadeSamples = (size_t) juce::jlimit(0, (int) numSamples, fadeLength - fadeStart);
+
+    const auto step = juce::MathConstants<double>::halfPi / (double) fadeLength;
+    const auto stepSin = std::sin(step), stepCos = std::cos(step);
+    auto newGain = std::sin(step * fadeStart), oldGain = std::cos(step * fadeStart);
+
+    for (size_t i = 0; i < numFadeSamples; ++i)
+    {
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            auto& sample = block.getChannelPointer(channel)[i];
+            sample = (float) newGain * sample + (float) oldGain * outgoingBlock.getChannelPointer(channel)[i];
+        }
+
+        const auto nextNewGain = newGain * stepCos + oldGain * stepSin;
+        oldGain = oldGain * stepCos - newGain * stepSin;
+        newGain = nextNewGain;
+    }
+}
+
+juce::int64 _3BandEQTutorialAudioProcessor::getBlockPosition() const noexcept
+{
+    // prefer the host's timeline so loops and seeks stay on the grid, otherwise just keep counting
+    if (auto* playHead = getPlayHead())
+        if (auto position = playHead->getPosition())
+            if (auto timeInSamples = position->getTimeInSamples())
+                return juce::jmax((juce::int64) 0, *timeInSamples);
+
+    return nextBlockPosition;
+}
+
+//==============================================================================
+int _3BandEQTutorialAudioProcessor::getProcessingLatency() const noexcept
+{
+    if (linearPhaseActive)
+        return linearPhaseEngine.getLatencySamples();
+
+    if (oversampler != nullptr)
+        return juce::roundToInt(oversampler->getLatencyInSamples());
+
+    return 0;
+}
+
+int _3BandEQTutorialAudioProcessor::computeTailSamples(const CoefficientSet& coefficientSet) const noexcept
+{
+    // the FIR rings for its full length after the input stops, on top of the convolver's partition delay
+    if (linearPhaseActive)
+        return linearPhaseEngine.getFIRLength() + LinearPhaseEngine::partitionSize;
+
+    // otherwise until the slowest poles have decayed by 120 dB, plus the oversampler's delay
+    const auto decaySeconds = getDecayTimeSeconds(coefficientSet, -120.0, getSelectedDynamicMode() != DYNAMIC_OFF);
+    return getProcessingLatency() + juce::roundToInt(decaySeconds * coefficientSet.sampleRate);
+}
+
+void _3BandEQTutorialAudioProcessor::updateSleepState(const juce::dsp::AudioBlock<float>& block) noexcept
+{
+    const auto range = block.findMinAndMax();
+
+    if (juce::jmax(-range.getStart(), range.getEnd()) > silenceThreshold)
+    {
+        silentSamples = 0;
+        sleeping = false;
+        return;
+    }
+
+   #if EQ_ENABLE_TELEMETRY
+    telemetry.addSilentBlock();
+   #endif
+
+    // silentSamples doesn't include this block yet, so the whole tail has already been played out
+   #if EQ_NUM_USER_BANDS > 0
+    const auto userBandsSettled = silentSamples >= tailSamples.load(std::memory_order_relaxed) + userBandTailSamples.load(std::memory_order_relaxed)
+                               && userBandEngine.getStateMagnitude() < silenceThreshold
+                               && (userBandFadePosition >= userBandFadeLength || userBandFadeEngine.getStateMagnitude() < silenceThreshold);
+   #else
+    const auto userBandsSettled = true;
+   #endif
+
+    if (!sleeping
+        && userBandsSettled
+        && silentSamples >= tailSamples.load(std::memory_order_relaxed)
+        && filterEngine.getStateMagnitude() < silenceThreshold
+        && oversampledEngine.getStateMagnitude() < silenceThreshold)
+    {
+        // flush whatever is left, so waking up starts from clean state with no work to do
+        filterEngine.reset();
+        oversampledEngine.reset();
+
+        if (oversampler != nullptr)
+            oversampler->reset();
+
+        if (linearPhaseActive)
+            linearPhaseEngine.reset();
+
+        dynamicPeak.reset();
+
+       #if EQ_NUM_USER_BANDS > 0
+        userBandEngine.reset();
+        userBandFadeEngine.reset();
+        userBandFadePosition = userBandFadeLength;
+       #endif
+
+        programFadePosition = programFadeLength;
+        sleeping = true;
+    }
+
+    silentSamples = juce::jmin(silentSamples + (int) block.getNumSamples(), std::numeric_limits<int>::max() / 2);
+}
+
+bool _3BandEQTutorialAudioProcessor::isRePrepareNeeded() const
+{
+    // not prepared, or released since: the next prepareToPlay picks the new settings up
+    const juce::ScopedLock prepareScope(prepareLock);
+
+    return prepared
+        && (isLinearPhaseSelected() != linearPhaseActive
+            || (linearPhaseActive && getSelectedFIRLength() != linearPhaseEngine.getFIRLength())
+            || getSelectedOversamplingFactor() != oversamplingFactor
+            || getSelectedTopology() != filterEngine.getTopology());
+}
+
+void _3BandEQTutorialAudioProcessor::timerCallback()
+{
+    // checked first, so the host only outputs silence when a setting really changed
+    if (!isRePrepareNeeded())
+        return;
+
+    // a full re-prepare, with the host outputting silence meanwhile. Processing is suspended before the prepare
+    // lock is taken, a host may hold its callback lock while it prepares.
+    suspendProcessing(true);
+
+    {
+        const juce::ScopedLock prepareScope(prepareLock);
+
+        if (isRePrepareNeeded())
+            prepareToPlay(getSampleRate(), getBlockSize());
+    }
 
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+    suspendProcessing(false);
+}
 
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+void _3BandEQTutorialAudioProcessor::applyCoefficients(const CoefficientSet& coefficientSet)
+{
+    // linked stereo, every lane gets the same coefficients.
+    // When oversampling, the low cut stays at the base rate and only the bands near Nyquist run oversampled.
+    if (oversampler != nullptr)
+    {
+        filterEngine.setCoefficients(coefficientSet, LOW_CUT_BAND);
+        oversampledEngine.setCoefficients(coefficientSet, PEAK_BAND | HIGH_CUT_BAND);
+    }
+    else
+    {
+        filterEngine.setCoefficients(coefficientSet);
+    }
 
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    dynamicPeak.setDetectorBandPass(coefficientSet.detectorBandPass);
+    tailSamples.store(computeTailSamples(coefficientSet), std::memory_order_relaxed);
 
+   #if EQ_ENABLE_TELEMETRY
+    telemetry.addRedesign();
+   #endif
 }
 
+#if EQ_NUM_USER_BANDS > 0
+void _3BandEQTutorialAudioProcessor::applyUserBands(const ParallelSections& sections) noexcept
+{
+    const auto sampleRate = getSampleRate();
+
+    // only a change of form needs the fade, within one form the state carries straight over
+    if (sections.isParallel != userBandEngine.isParallelForm() && !sleeping)
+    {
+        const auto settleSeconds = juce::jlimit(minUserBandFadeSeconds, maxUserBandFadeSeconds, getDecayTimeSeconds(sections, sampleRate, -60.0));
+
+        userBandFadeEngine.copyFrom(userBandEngine);
+        userBandFadeLength = juce::roundToInt(settleSeconds * sampleRate);
+        userBandFadePosition = 0;
+    }
+
+    userBandEngine.setSections(sections);
+    userBandTailSamples.store(juce::roundToInt(getDecayTimeSeconds(sections, sampleRate) * sampleRate), std::memory_order_relaxed);
+}
+
+void _3BandEQTutorialAudioProcessor::processUserBands(const juce::dsp::AudioBlock<float>& block) noexcept
+{
+    if (userBandFadePosition >= userBandFadeLength)
+    {
+        userBandEngine.process(block);
+        return;
+    }
+
+    const auto numSamples = block.getNumSamples();
+    const auto numChannels = block.getNumChannels();
+
+    // the program fade is done with the scratch buffer by now
+    auto outgoingBlock = juce::dsp::AudioBlock<float>(fadeBuffer).getSubsetChannelBlock(0, numChannels).getSubBlock(0, numSamples);
+    outgoingBlock.copyFrom(block);
+
+    userBandEngine.process(block);
+    userBandFadeEngine.process(outgoingBlock);
+
+    // both forms have the same response, so a linear fade keeps the level where an equal power one would bulge
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        const auto newGain = juce::jmin(1.0f, (float) (userBandFadePosition + (int) i) / (float) userBandFadeLength);
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            auto& sample = block.getChannelPointer(channel)[i];
+            const auto outgoing = outgoingBlock.getChannelPointer(channel)[i];
+            sample = outgoing + newGain * (sample - outgoing);
+        }
+    }
+
+    userBandFadePosition += (int) numSamples;
+}
+#endif
+
 //==============================================================================
 bool _3BandEQTutorialAudioProcessor::hasEditor() const
 {
@@ -290,40 +825,33 @@ juce::AudioProcessorEditor* _3BandEQTutorialAudioProcessor::createEditor()
 {
     //return new _3BandEQTutorialAudioProcessorEditor (*this);
 
-    // Temporary GUI for parameter management
-    return new juce::GenericAudioProcessorEditor(*this);
+    // Band controls and the response display, plus the telemetry overlay when it's compiled in
+    return new _3BandEQTutorialAudioProcessorEditor(*this);
 }
 
 //==============================================================================
 void _3BandEQTutorialAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    // compact binary, see PluginState.h for the layout
+    writeBinaryState(parameterManager, destData);
 }
 
 void _3BandEQTutorialAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
-}
-// implementing chainsetting grab
+    // binary states go straight into the parameters, XML from older sessions through the value tree
+    if (!readBinaryState(parameterManager, data, sizeInBytes)
+        && !readXmlState(parameterManager, data, sizeInBytes))
+        return;
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& parameterManager)
-{
-    ChainSettings settings;
+    // design now rather than on the designer thread's next poll, so the first block after a restore
+    // already runs the restored settings. Before prepareToPlay this is a no-op and prepare designs everything.
+    coefficientDesigner.designPendingChanges();
 
-    settings.lowCutFreq = parameterManager.getRawParameterValue("LowCut Freq")->load();
-    settings.highCutFreq = parameterManager.getRawParameterValue("HiCut Freq")->load();
-    settings.peakFreq = parameterManager.getRawParameterValue("Peak Freq")->load();
-    settings.peakGainInDecibels = parameterManager.getRawParameterValue("Peak Gain")->load();
-    settings.peakQuality = parameterManager.getRawParameterValue("Quality")->load();
-    settings.lowCutSlope = static_cast<Slope>(parameterManager.getRawParameterValue("LowCut Slope")->load());
-    settings.highCutSlope = static_cast<Slope>(parameterManager.getRawParameterValue("HiCut Slope")->load());
-    return settings; 
+   #if EQ_NUM_USER_BANDS > 0
+    userBandDesigner.designPendingChanges();
+   #endif
 }
 
-
 juce::AudioProcessorValueTreeState::ParameterLayout _3BandEQTutorialAudioProcessor::returnParameterLayout()
 {
     // Parameter declaration
@@ -356,9 +884,90 @@ juce::AudioProcessorValueTreeState::ParameterLayout _3BandEQTutorialAudioProcess
         layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope", "LowCut Slope", choices, 0));
         layout.add(std::make_unique<juce::AudioParameterChoice>("HiCut Slope", "HiCut Slope", choices, 0));
 
+    // Changing any of the structural settings re-prepares the plugin, so hosts aren't offered them for automation
+    const auto structuralAttributes = juce::AudioParameterChoiceAttributes().withAutomatable(false);
+
+    // Linear phase trades latency for phase coherence, longer FIRs resolve lower frequencies
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Phase Mode", "Phase Mode",
+        juce::StringArray{ "Minimum Phase", "Linear Phase" }, 0, structuralAttributes));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("FIR Length", "FIR Length",
+        juce::StringArray{ "1024 taps", "2048 taps", "4096 taps", "8192 taps", "16384 taps" }, 2, structuralAttributes));
+
+    // Runs the peak and high cut oversampled, so they don't cramp near Nyquist at 44.1/48 kHz
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling", "Oversampling",
+        juce::StringArray{ "1x", "2x", "4x" }, 0, structuralAttributes));
+
+    // Coefficient smoothing, trades CPU for zipper-free automation
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Control Rate", "Control Rate",
+        juce::StringArray{ "Off", "8 samples", "16 samples", "32 samples", "64 samples" }, 0));
+
+    // State variable filters stay accurate in float for very low cutoffs at high sample rates, at a little more CPU
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Filter Topology", "Filter Topology",
+        juce::StringArray{ "Direct Form", "State Variable" }, 0, structuralAttributes));
+
+    // Dynamic EQ on the peak band: above the threshold the band is turned down by the ratio, on top of "Peak Gain".
+    // Minimum phase only, linear phase keeps the static band.
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Dynamic Mode", "Dynamic Mode",
+        juce::StringArray{ "Off", "Input", "Sidechain" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Dynamic Threshold", "Dynamic Threshold",
+        juce::NormalisableRange<float>(-60.0f, 0.0f, 0.5f),
+        -20.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Dynamic Ratio", "Dynamic Ratio",
+        juce::NormalisableRange<float>(1.0f, 20.0f, 0.1f, 0.4f),
+        2.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Dynamic Attack", "Dynamic Attack",
+        juce::NormalisableRange<float>(0.1f, 100.0f, 0.1f, 0.4f),
+        5.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Dynamic Release", "Dynamic Release",
+        juce::NormalisableRange<float>(5.0f, 2000.0f, 1.0f, 0.4f),
+        100.0f));
+
+   #if EQ_NUM_USER_BANDS > 0
+    // "Band 1 Type" ... "Band N Q", each band one peak, shelf, notch or 12 dB/Oct cut section
+    addUserBandParameters(layout, EQ_NUM_USER_BANDS);
+   #endif
+
     return layout;
 }
 
+int _3BandEQTutorialAudioProcessor::getControlInterval() const noexcept
+{
+    static constexpr int controlIntervals[] = { unsmoothedControlInterval, 8, 16, 32, 64 };
+
+    auto index = juce::jlimit(0, (int) std::size(controlIntervals) - 1, (int) controlRate->load());
+    return controlIntervals[index];
+}
+
+bool _3BandEQTutorialAudioProcessor::isSmoothingSelected() const noexcept
+{
+    return controlRate->load() >= 0.5f;
+}
+
+int _3BandEQTutorialAudioProcessor::getSelectedFIRLength() const noexcept
+{
+    return 1024 << juce::jlimit(0, 4, (int) firLength->load());
+}
+
+int _3BandEQTutorialAudioProcessor::getSelectedOversamplingFactor() const noexcept
+{
+    return 1 << juce::jlimit(0, 2, (int) oversampling->load());
+}
+
+SIMDFilterEngine::Topology _3BandEQTutorialAudioProcessor::getSelectedTopology() const noexcept
+{
+    return filterTopology->load() >= 0.5f ? SIMDFilterEngine::STATE_VARIABLE : SIMDFilterEngine::DIRECT_FORM;
+}
+
+_3BandEQTutorialAudioProcessor::DynamicMode _3BandEQTutorialAudioProcessor::getSelectedDynamicMode() const noexcept
+{
+    return static_cast<DynamicMode>(juce::jlimit(0, (int) DYNAMIC_SIDECHAIN, (int) dynamicMode->load()));
+}
+
+bool _3BandEQTutorialAudioProcessor::isLinearPhaseSelected() const noexcept
+{
+    return phaseMode->load() >= 0.5f;
+}
+
 //==============================================================================
 // This creates new instances of the plugin..
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
@@ -9,33 +9,26 @@
 #pragma once
 
 #include <JuceHeader.h>
-
-
-// We save temp parameters as a struct so its easy to access
-enum Slope
-{
-    SLOPE_12,
-    SLOPE_24,
-    SLOPE_36,
-    SLOPE_48
-};
-
-struct ChainSettings
-{
-    float peakFreq{ 0 }, peakGainInDecibels{ 0 }, peakQuality{ 1.f };
-    float lowCutFreq{ 0 }, highCutFreq{ 0 };
-    Slope lowCutSlope{ Slope::SLOPE_12 }, highCutSlope{ Slope::SLOPE_12 };
-
-};
-
-
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& parameterManager);
+#include "ChainSettings.h"
+#include "CoefficientDesigner.h"
+#include "SIMDFilterEngine.h"
+#include "CoefficientSmoother.h"
+#include "LinearPhaseEngine.h"
+#include "SpectrumAnalyser.h"
+#include "PerformanceTelemetry.h"
+#include "PluginState.h"
+#include "PresetBank.h"
+#include "DynamicPeak.h"
+#include "UserBands.h"
+#include "ParallelFilterEngine.h"
+#include "RealtimeSafety.h"
 
 
 //==============================================================================
 /**
 */
-class _3BandEQTutorialAudioProcessor  : public juce::AudioProcessor
+class _3BandEQTutorialAudioProcessor  : public juce::AudioProcessor,
+                                        private juce::Timer
 {
 public:
     //==============================================================================
@@ -77,27 +70,179 @@ public:
 
     static juce::AudioProcessorValueTreeState::ParameterLayout returnParameterLayout();
 
-    // Declaration of parameter variable
-    juce::AudioProcessorValueTreeState parameterManager{ *this, nullptr, "Parameters", returnParameterLayout()};
-
-private:
-    // Template definitions
-    using Filter = juce::dsp::IIR::Filter<float>;
+    // Samples between coefficient updates. With "Control Rate" off the coefficients jump instead of ramping,
+    // but they still only move on this grid.
+    int getControlInterval() const noexcept;
+    bool isSmoothingSelected() const noexcept;
 
-    using CutFilter = juce::dsp::ProcessorChain < Filter, Filter, Filter, Filter>;
+    // Taps of the linear-phase FIR selected by "FIR Length"
+    int getSelectedFIRLength() const noexcept;
+    bool isLinearPhaseSelected() const noexcept;
 
-    using MonoChain = juce::dsp::ProcessorChain <CutFilter, Filter, CutFilter>;
+    // 1, 2 or 4, from "Oversampling"
+    int getSelectedOversamplingFactor() const noexcept;
 
-    MonoChain leftChain, rightChain;
+    // IIR structure selected by "Filter Topology"
+    SIMDFilterEngine::Topology getSelectedTopology() const noexcept;
 
-    enum ChainPositions
+    // Where the peak band's dynamic mode takes its detector signal from, see "Dynamic Mode"
+    enum DynamicMode
     {
-        LowCut,
-        Peak,
-        HighCut
+        DYNAMIC_OFF,
+        DYNAMIC_INPUT,
+        DYNAMIC_SIDECHAIN
     };
 
-    
+    DynamicMode getSelectedDynamicMode() const noexcept;
+
+    // Current band settings straight from the parameters, safe from any thread
+    ChainSettings getCurrentChainSettings() const noexcept { return getChainSettings(chainParameters); }
+
+    // Bytes of coefficient and filter state memory used by this instance, the engines and the arena they share
+    size_t getFilterMemoryFootprint() const noexcept
+    {
+        return filterArena.getSize() + filterEngine.getMemoryFootprint() + oversampledEngine.getMemoryFootprint()
+             + fadeEngine.getMemoryFootprint() + fadeOversampledEngine.getMemoryFootprint()
+            #if EQ_NUM_USER_BANDS > 0
+             + userBandEngine.getMemoryFootprint() + userBandFadeEngine.getMemoryFootprint()
+            #endif
+             ;
+    }
+
+    // Replaces the program bank with a bank file, see PresetBank.h. Returns false if the file isn't a valid bank.
+    bool loadPresetBank(const juce::File& file);
+
+    // Loaded at construction if it exists, otherwise the factory presets are used
+    static juce::File getDefaultPresetBankFile();
+
+    SpectrumAnalyser& getAnalyser() noexcept { return analyser; }
+
+   #if EQ_ENABLE_TELEMETRY
+    PerformanceTelemetry& getTelemetry() noexcept { return telemetry; }
+   #endif
+
+    // Declaration of parameter variable
+    juce::AudioProcessorValueTreeState parameterManager{ *this, nullptr, "Parameters", returnParameterLayout()};
+
+private:
+    // One cache-line aligned allocation holding every engine's coefficients, state and scratch space,
+    // carved up in prepareToPlay
+    FilterArena filterArena;
+
+    // Every channel of the main bus runs through one cascade, one channel per SIMD lane
+    SIMDFilterEngine filterEngine;
+
+    // Declared before the designer, which calls into it from the designer thread until it's destroyed
+    LinearPhaseEngine linearPhaseEngine;
+    bool linearPhaseActive{ false };
+
+    // Only allocated while oversampling, the peak and high cut then run in their own engine at the higher rate
+    std::unique_ptr<juce::dsp::Oversampling<float>> oversampler;
+    SIMDFilterEngine oversampledEngine;
+    int oversamplingFactor{ 1 };
+
+    ChainParameters chainParameters{ getChainParameters(parameterManager) };
+    CoefficientDesigner coefficientDesigner{ parameterManager, chainParameters };
+
+    // "Phase Mode", "FIR Length", "Oversampling" and "Filter Topology" change latency or allocation, so they aren't
+    // automatable and a message thread timer re-prepares when one of them changed. prepareLock keeps that from
+    // running into a prepareToPlay or releaseResources from the host.
+    static constexpr int structuralPollIntervalMs = 100;
+    juce::CriticalSection prepareLock;
+    bool prepared{ false };
+
+    std::atomic<float>* phaseMode{ parameterManager.getRawParameterValue("Phase Mode") };
+    std::atomic<float>* firLength{ parameterManager.getRawParameterValue("FIR Length") };
+    std::atomic<float>* oversampling{ parameterManager.getRawParameterValue("Oversampling") };
+    std::atomic<float>* filterTopology{ parameterManager.getRawParameterValue("Filter Topology") };
+
+    // The IIR chain's coefficients only change on a grid of control interval boundaries. With "Control Rate" off
+    // they're the designer thread's sets, pulled at block start and applied at the next boundary. On, the smoother
+    // ramps them and designs on the audio thread, but only while something is moving.
+    static constexpr int unsmoothedControlInterval = 32;
+    std::atomic<float>* controlRate{ parameterManager.getRawParameterValue("Control Rate") };
+    CoefficientSmoother coefficientSmoother;
+    CoefficientSet smoothedCoefficients;
+    bool smoothingActive{ false }, designedSetPending{ false };
+
+    // Pre and post EQ spectra for the editor, idle unless an editor is open
+    SpectrumAnalyser analyser;
+
+    // Absolute position of the next block, so control intervals land on the same samples whatever the host block size
+    juce::int64 nextBlockPosition{ 0 };
+
+    // Samples per block prepareToPlay sized everything for, larger host blocks are processed in pieces of this size
+    int preparedBlockSize{ 0 };
+
+    // Silence detection. Once the input has been quiet for the whole tail and the IIR state has settled,
+    // the filters go to sleep: their state is flushed and blocks are cleared instead of processed.
+    static constexpr float silenceThreshold = 1.0e-6f; // about -120 dBFS
+    std::atomic<int> tailSamples{ 0 };
+    int silentSamples{ 0 };
+    bool sleeping{ false };
+
+   #if EQ_ENABLE_TELEMETRY
+    PerformanceTelemetry telemetry;
+   #endif
+
+    // Program bank. setCurrentProgram designs the program's set on its first selection and publishes a pointer
+    // to it, the audio thread then crossfades from a copy of the old filters to the new ones.
+    // programWriteSequence is odd while a program's parameters are being written, so the audio thread
+    // never reads half of one (a seqlock with the parameters and the pending set as its data).
+    static constexpr double programFadeSeconds = 0.01;
+    PresetBank presetBank;
+    int currentProgram{ 0 };
+    std::atomic<const CoefficientSet*> pendingProgramSet{ nullptr };
+    std::atomic<juce::uint32> programWriteSequence{ 0 };
+    SIMDFilterEngine fadeEngine, fadeOversampledEngine;
+    juce::AudioBuffer<float> fadeBuffer, oversampledFadeBuffer;
+    int programFadeLength{ 0 }, programFadePosition{ 0 };
+
+    // Dynamic mode for the peak band. The detector runs once per block, the engine running the peak
+    // then applies its per-sample gain, held for each oversampled sample when oversampling.
+    std::atomic<float>* dynamicMode{ parameterManager.getRawParameterValue("Dynamic Mode") };
+    std::atomic<float>* dynamicThreshold{ parameterManager.getRawParameterValue("Dynamic Threshold") };
+    std::atomic<float>* dynamicRatio{ parameterManager.getRawParameterValue("Dynamic Ratio") };
+    std::atomic<float>* dynamicAttack{ parameterManager.getRawParameterValue("Dynamic Attack") };
+    std::atomic<float>* dynamicRelease{ parameterManager.getRawParameterValue("Dynamic Release") };
+    DynamicPeak dynamicPeak;
+    std::vector<float> oversampledModulation;
+
+   #if EQ_NUM_USER_BANDS > 0
+    // The extra bands, run after the three band chain at the base rate, minimum phase even in linear phase mode
+    UserBandDesigner userBandDesigner{ parameterManager, EQ_NUM_USER_BANDS };
+    ParallelFilterEngine userBandEngine;
+    std::atomic<int> userBandTailSamples{ 0 };
+
+    // Switching between parallel and cascade form can't carry the filter state over, so a copy of the old
+    // form plays on and fades out while the new one fills up, for as long as the new form takes to settle
+    static constexpr double minUserBandFadeSeconds = 0.01, maxUserBandFadeSeconds = 0.5;
+    ParallelFilterEngine userBandFadeEngine;
+    int userBandFadeLength{ 0 }, userBandFadePosition{ 0 };
+
+    void applyUserBands(const ParallelSections& sections) noexcept;
+    void processUserBands(const juce::dsp::AudioBlock<float>& block) noexcept;
+   #endif
+
+    juce::int64 getBlockPosition() const noexcept;
+    void processChunk(const juce::dsp::AudioBlock<float>& block, juce::int64 blockPosition);
+
+    bool isRePrepareNeeded() const;
+    void timerCallback() override;
+    int getProcessingLatency() const noexcept;
+    int computeTailSamples(const CoefficientSet& coefficientSet) const noexcept;
+    void updateSleepState(const juce::dsp::AudioBlock<float>& block) noexcept;
+
+    void applyCoefficients(const CoefficientSet& coefficientSet);
+    const float* processDynamics(const juce::dsp::AudioBlock<float>& block) noexcept;
+    void processControlIntervals(juce::dsp::AudioBlock<float>& block, int controlInterval, juce::int64 blockPosition, const float* peakModulation);
+    void processIIR(const juce::dsp::AudioBlock<float>& block, const float* peakModulation) noexcept;
+
+    bool isProgramFading() const noexcept { return programFadePosition < programFadeLength; }
+    bool readChainSettings(ChainSettings& chainSettings, const CoefficientSet*& programSet) noexcept;
+    void startProgramChange(const CoefficientSet& programSet, const ChainSettings& programSettings) noexcept;
+    void processCrossfaded(SIMDFilterEngine& engine, SIMDFilterEngine& outgoingEngine, const juce::dsp::AudioBlock<float>& block,
+                           juce::AudioBuffer<float>& scratch, int rateFactor, const float* peakModulation) noexcept;
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (_3BandEQTutorialAudioProcessor)
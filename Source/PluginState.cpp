@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    PluginState.cpp
+
+  ==============================================================================
+*/
+
+#include "PluginState.h"
+
+//==============================================================================
+// stable across builds and platforms, unlike juce::String::hashCode
+static juce::uint32 getParameterIDHash(const juce::String& parameterID) noexcept
+{
+    juce::uint32 hash = 2166136261u;
+
+    for (auto* character = parameterID.toRawUTF8(); *character != 0; ++character)
+    {
+        hash ^= (juce::uint8) *character;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static juce::Array<juce::RangedAudioParameter*> getParameters(juce::AudioProcessorValueTreeState& parameterManager)
+{
+    juce::Array<juce::RangedAudioParameter*> parameters;
+
+    for (auto* parameter : parameterManager.processor.getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+            parameters.add(ranged);
+
+    return parameters;
+}
+
+//==============================================================================
+void writeBinaryState(juce::AudioProcessorValueTreeState& parameterManager, juce::MemoryBlock& destData)
+{
+    const auto parameters = getParameters(parameterManager);
+
+    destData.reset();
+    juce::MemoryOutputStream output(destData, false);
+
+    output.writeInt((int) binaryStateMagic);
+    output.writeShort((short) binaryStateVersion);
+    output.writeShort((short) parameters.size());
+
+    for (auto* parameter : parameters)
+    {
+        output.writeInt((int) getParameterIDHash(parameter->getParameterID()));
+        output.writeFloat(parameter->convertFrom0to1(parameter->getValue()));
+    }
+}
+
+bool readBinaryState(juce::AudioProcessorValueTreeState& parameterManager, const void* data, int sizeInBytes)
+{
+    static constexpr int headerSize = 8, entrySize = 8;
+
+    if (data == nullptr || sizeInBytes < headerSize)
+        return false;
+
+    juce::MemoryInputStream input(data, (size_t) sizeInBytes, false);
+
+    if ((juce::uint32) input.readInt() != binaryStateMagic)
+        return false;
+
+    // a newer version may have changed the meaning of the entries, so it isn't guessed at
+    const auto version = (juce::uint16) input.readShort();
+    const auto numEntries = (int) (juce::uint16) input.readShort();
+
+    if (version == 0 || version > binaryStateVersion || sizeInBytes < headerSize + numEntries * entrySize)
+        return false;
+
+    const auto parameters = getParameters(parameterManager);
+
+    juce::Array<juce::uint32> hashes;
+    hashes.ensureStorageAllocated(parameters.size());
+
+    for (auto* parameter : parameters)
+        hashes.add(getParameterIDHash(parameter->getParameterID()));
+
+    juce::Array<bool> restored;
+    restored.insertMultiple(0, false, parameters.size());
+
+    for (int entry = 0; entry < numEntries; ++entry)
+    {
+        const auto hash = (juce::uint32) input.readInt();
+        const auto value = input.readFloat();
+        const auto index = hashes.indexOf(hash);
+
+        // an entry from a parameter this build doesn't have
+        if (index < 0)
+            continue;
+
+        auto* parameter = parameters.getUnchecked(index);
+        const auto normalisedValue = parameter->convertTo0to1(value);
+
+        if (parameter->getValue() != normalisedValue)
+            parameter->setValueNotifyingHost(normalisedValue);
+
+        restored.set(index, true);
+    }
+
+    for (int index = 0; index < parameters.size(); ++index)
+    {
+        auto* parameter = parameters.getUnchecked(index);
+
+        if (!restored[index] && parameter->getValue() != parameter->getDefaultValue())
+            parameter->setValueNotifyingHost(parameter->getDefaultValue());
+    }
+
+    return true;
+}
+
+bool readXmlState(juce::AudioProcessorValueTreeState& parameterManager, const void* data, int sizeInBytes)
+{
+    if (data == nullptr || sizeInBytes <= 0)
+        return false;
+
+    auto xml = juce::AudioProcessor::getXmlFromBinary(data, sizeInBytes);
+
+    if (xml == nullptr)
+        xml = juce::parseXML(juce::String::fromUTF8(static_cast<const char*>(data), sizeInBytes));
+
+    if (xml == nullptr || !xml->hasTagName(parameterManager.state.getType()))
+        return false;
+
+    parameterManager.replaceState(juce::ValueTree::fromXml(*xml));
+    return true;
+}
@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    PluginState.h
+    Saving and restoring the parameters. The compact binary format is what
+    getStateInformation writes, the XML format is still read for older
+    sessions and hand written state files.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+
+//==============================================================================
+/*
+    Binary layout, little endian:
+
+        uint32  magic "EQST"
+        uint16  version
+        uint16  number of entries
+        then per entry:
+            uint32  FNV-1a hash of the parameter ID
+            float   value in the parameter's own units
+
+    Entries are matched by ID hash, so parameters can be added, removed or
+    reordered between versions. Values are stored denormalised, so a changed
+    range still restores the same frequency or gain.
+*/
+static constexpr juce::uint32 binaryStateMagic = 0x54535145; // "EQST"
+static constexpr juce::uint16 binaryStateVersion = 1;
+
+void writeBinaryState(juce::AudioProcessorValueTreeState& parameterManager, juce::MemoryBlock& destData);
+
+// Restores straight into the parameters, no ValueTree or XML involved. Parameters missing from the
+// state go back to their defaults. Returns false, changing nothing, if the data isn't a valid binary state.
+bool readBinaryState(juce::AudioProcessorValueTreeState& parameterManager, const void* data, int sizeInBytes);
+
+// Accepts copyXmlToBinary() data or plain XML text. Returns false, changing nothing, if neither parses.
+bool readXmlState(juce::AudioProcessorValueTreeState& parameterManager, const void* data, int sizeInBytes);
@@ -0,0 +1,180 @@
+/*
+  ==============================================================================
+
+    PresetBank.cpp
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+
+//==============================================================================
+static ChainSettings makeSettings(float lowCutFreq, Slope lowCutSlope, float peakFreq, float peakGainInDecibels, float peakQuality,
+                                  float highCutFreq, Slope highCutSlope)
+{
+    ChainSettings settings;
+
+    settings.lowCutFreq = lowCutFreq;
+    settings.lowCutSlope = lowCutSlope;
+    settings.peakFreq = peakFreq;
+    settings.peakGainInDecibels = peakGainInDecibels;
+    settings.peakQuality = peakQuality;
+    settings.highCutFreq = highCutFreq;
+    settings.highCutSlope = highCutSlope;
+    return settings;
+}
+
+static void writeRecord(juce::MemoryOutputStream& output, const PresetBank::Preset& preset)
+{
+    char name[PresetBank::maxNameLength + 1] = {};
+    preset.name.copyToUTF8(name, sizeof(name));
+    output.write(name, sizeof(name));
+
+    auto& settings = preset.settings;
+
+    for (auto value : { settings.lowCutFreq, settings.highCutFreq, settings.peakFreq, settings.peakGainInDecibels, settings.peakQuality })
+        output.writeFloat(value);
+
+    output.writeByte((char) settings.lowCutSlope);
+    output.writeByte((char) settings.highCutSlope);
+    output.writeShort(0);
+}
+
+static float readFloat(const char* data) noexcept
+{
+    const auto bits = juce::ByteOrder::littleEndianInt(data);
+
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+//==============================================================================
+PresetBank::PresetBank()
+{
+    loadFactoryPresets();
+}
+
+void PresetBank::loadFactoryPresets()
+{
+    const juce::Array<Preset> factoryPresets{
+        { "Flat",            makeSettings(20.0f, SLOPE_12, 750.0f, 0.0f, 1.0f, 20000.0f, SLOPE_12) },
+        { "Rumble Filter",   makeSettings(40.0f, SLOPE_48, 750.0f, 0.0f, 1.0f, 20000.0f, SLOPE_12) },
+        { "Vocal Presence",  makeSettings(90.0f, SLOPE_24, 3000.0f, 4.0f, 0.8f, 18000.0f, SLOPE_12) },
+        { "De-Mud",          makeSettings(60.0f, SLOPE_12, 300.0f, -5.0f, 1.5f, 20000.0f, SLOPE_12) },
+        { "Air",             makeSettings(20.0f, SLOPE_12, 12000.0f, 5.0f, 0.5f, 20000.0f, SLOPE_12) },
+        { "Telephone",       makeSettings(400.0f, SLOPE_48, 1500.0f, 6.0f, 1.0f, 3400.0f, SLOPE_48) },
+        { "Kick Punch",      makeSettings(30.0f, SLOPE_36, 70.0f, 4.5f, 1.2f, 10000.0f, SLOPE_24) },
+        { "Dark Master",     makeSettings(25.0f, SLOPE_24, 2500.0f, -2.0f, 0.6f, 12000.0f, SLOPE_12) }
+    };
+
+    factoryRecords.reset();
+    juce::MemoryOutputStream output(factoryRecords, false);
+
+    for (auto& preset : factoryPresets)
+        writeRecord(output, preset);
+
+    output.flush();
+    mappedFile.reset();
+    useRecords(factoryRecords.getData(), factoryPresets.size());
+}
+
+bool PresetBank::loadFromFile(const juce::File& file)
+{
+    auto newMappedFile = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+    auto* data = static_cast<const char*>(newMappedFile->getData());
+    const auto size = newMappedFile->getSize();
+
+    if (data == nullptr || size < (size_t) headerSize
+        || juce::ByteOrder::littleEndianInt(data) != magicNumber
+        || juce::ByteOrder::littleEndianInt(data + 4) == 0
+        || juce::ByteOrder::littleEndianInt(data + 4) > currentVersion)
+        return false;
+
+    const auto newNumPresets = (int) juce::ByteOrder::littleEndianInt(data + 8);
+
+    if (newNumPresets <= 0 || size < (size_t) headerSize + (size_t) newNumPresets * recordSize)
+        return false;
+
+    mappedFile = std::move(newMappedFile);
+    factoryRecords.reset();
+    useRecords(data + headerSize, newNumPresets);
+    return true;
+}
+
+bool PresetBank::writeToFile(const juce::File& file, const juce::Array<Preset>& presets)
+{
+    juce::MemoryBlock data;
+    juce::MemoryOutputStream output(data, false);
+
+    output.writeInt((int) magicNumber);
+    output.writeInt((int) currentVersion);
+    output.writeInt(presets.size());
+
+    for (auto& preset : presets)
+        writeRecord(output, preset);
+
+    output.flush();
+    return file.replaceWithData(data.getData(), data.getSize());
+}
+
+void PresetBank::useRecords(const void* data, int newNumPresets)
+{
+    records = static_cast<const char*>(data);
+    numPresets = newNumPresets;
+
+    // designed for the previous records, prepare() has to run again
+    designedSets.clear();
+    isDesigned.clear();
+}
+
+//==============================================================================
+juce::String PresetBank::getName(int index) const
+{
+    if (!juce::isPositiveAndBelow(index, numPresets))
+        return {};
+
+    auto* name = records + (size_t) index * recordSize;
+    return juce::String::fromUTF8(name, (int) strnlen(name, maxNameLength + 1));
+}
+
+ChainSettings PresetBank::getSettings(int index) const noexcept
+{
+    if (!juce::isPositiveAndBelow(index, numPresets))
+        return {};
+
+    auto* values = records + (size_t) index * recordSize + maxNameLength + 1;
+    auto toSlope = [](char slope) { return static_cast<Slope>(juce::jlimit(0, (int) SLOPE_48, (int) (juce::uint8) slope)); };
+
+    return makeSettings(readFloat(values), toSlope(values[20]), readFloat(values + 8), readFloat(values + 12), readFloat(values + 16),
+                        readFloat(values + 4), toSlope(values[21]));
+}
+
+void PresetBank::prepare(juce::AudioProcessorValueTreeState& parameterManager, double sampleRate, int oversamplingFactor)
+{
+    designParameters = &parameterManager;
+    designRate = sampleRate;
+    designOversamplingFactor = oversamplingFactor;
+
+    designedSets.resize((size_t) numPresets);
+    isDesigned.assign((size_t) numPresets, 0);
+}
+
+const CoefficientSet* PresetBank::getDesignedSet(int index)
+{
+    if (designParameters == nullptr || !juce::isPositiveAndBelow(index, (int) designedSets.size()))
+        return nullptr;
+
+    auto& set = designedSets[(size_t) index];
+
+    // designed from the snapped values, so once the parameters follow the program the designer comes up with the same set.
+    // A set the audio thread may be using is never designed again, only sets that haven't been handed out yet.
+    if (isDesigned[(size_t) index] == 0)
+    {
+        designCoefficients(set, getLegalChainSettings(*designParameters, getSettings(index)),
+                           designRate, ALL_BANDS, designOversamplingFactor, true);
+        isDesigned[(size_t) index] = 1;
+    }
+
+    return &set;
+}
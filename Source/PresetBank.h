@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+    The program bank. Presets are read straight out of a memory-mapped bank
+    file, and a preset's coefficients are designed the first time it's
+    selected, so a program change never has to wait for the designer thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "CoefficientDesigner.h"
+
+
+//==============================================================================
+/**
+    Bank file layout, little endian:
+
+        uint32  magic "EQPB"
+        uint32  version
+        uint32  number of presets
+        then one 64 byte record per preset:
+            char    name[40], UTF-8, zero padded
+            float   low cut, high cut and peak frequency, peak gain (dB), peak Q
+            uint8   low cut slope, high cut slope (Slope index)
+            uint8   padding[2]
+
+    Mapping the file costs the same whatever its size: names and settings are
+    only read when they're asked for. Without a bank file the factory presets
+    are used, stored in the same record layout.
+*/
+class PresetBank
+{
+public:
+    struct Preset
+    {
+        juce::String name;
+        ChainSettings settings;
+    };
+
+    static constexpr juce::uint32 magicNumber = 0x42505145; // "EQPB"
+    static constexpr juce::uint32 currentVersion = 1;
+    static constexpr int maxNameLength = 39;
+
+    PresetBank();
+
+    // Maps a bank file. Returns false and keeps the current presets if it isn't a valid bank.
+    bool loadFromFile(const juce::File& file);
+    void loadFactoryPresets();
+
+    static bool writeToFile(const juce::File& file, const juce::Array<Preset>& presets);
+
+    int getNumPresets() const noexcept { return numPresets; }
+    juce::String getName(int index) const;
+    ChainSettings getSettings(int index) const noexcept;
+
+    // Sets the rate presets are designed for and forgets any designed before. Designs nothing itself,
+    // so it costs the same however many presets the bank holds. Not realtime safe.
+    void prepare(juce::AudioProcessorValueTreeState& parameterManager, double sampleRate, int oversamplingFactor);
+
+    // Designs the preset on first use, as the parameters would hold it. Not realtime safe, call it from the thread
+    // selecting the program. nullptr until prepare() has been called. A set stays put until the next prepare() or load.
+    const CoefficientSet* getDesignedSet(int index);
+
+private:
+    static constexpr int headerSize = 12, recordSize = 64;
+
+    void useRecords(const void* data, int newNumPresets);
+
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    juce::MemoryBlock factoryRecords;
+    const char* records{ nullptr };
+    int numPresets{ 0 };
+
+    juce::AudioProcessorValueTreeState* designParameters{ nullptr };
+    double designRate{ 0 };
+    int designOversamplingFactor{ 1 };
+    std::vector<CoefficientSet> designedSets;
+    std::vector<char> isDesigned;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetBank)
+};
@@ -0,0 +1,120 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.cpp
+
+  ==============================================================================
+*/
+
+#include "RealtimeSafety.h"
+
+#if EQ_REALTIME_SAFETY_CHECKS
+
+#include <JuceHeader.h>
+#include <iostream>
+
+namespace
+{
+    // constant initialised, so reading them from inside malloc never allocates
+    thread_local int realtimeDepth = 0;
+    thread_local int allowanceDepth = 0;
+
+    // only the first few get a stack trace, a violation on every block would bury everything else
+    constexpr int64_t maxPrintedViolations = 8;
+
+    std::atomic<int64_t> numViolations{ 0 };
+    std::atomic<bool> abortOnViolation{ false };
+
+    void printViolation(RealtimeSafety::ViolationType type, const char* function)
+    {
+        const auto count = numViolations.load(std::memory_order_relaxed);
+
+        if (count > maxPrintedViolations)
+            return;
+
+        std::cerr << "realtime safety violation: " << RealtimeSafety::getName(type) << " (" << function << ") on the audio thread" << std::endl
+                  << juce::SystemStats::getStackBacktrace() << std::endl;
+
+        if (count == maxPrintedViolations)
+            std::cerr << "further violations are only counted" << std::endl;
+    }
+
+    std::atomic<RealtimeSafety::Handler> handler{ &printViolation };
+}
+
+//==============================================================================
+RealtimeSafety::ScopedRealtimeContext::ScopedRealtimeContext(bool isRealtime) noexcept
+    : active(isRealtime)
+{
+    if (active)
+        ++realtimeDepth;
+}
+
+RealtimeSafety::ScopedRealtimeContext::~ScopedRealtimeContext() noexcept
+{
+    if (active)
+        --realtimeDepth;
+}
+
+RealtimeSafety::ScopedAllowance::ScopedAllowance() noexcept
+{
+    ++allowanceDepth;
+}
+
+RealtimeSafety::ScopedAllowance::~ScopedAllowance() noexcept
+{
+    --allowanceDepth;
+}
+
+bool RealtimeSafety::isInRealtimeContext() noexcept
+{
+    return realtimeDepth > 0 && allowanceDepth == 0;
+}
+
+void RealtimeSafety::reportViolation(ViolationType type, const char* function) noexcept
+{
+    // the handler is free to allocate and lock, and none of that should be reported again
+    const ScopedAllowance allowance;
+
+    numViolations.fetch_add(1, std::memory_order_relaxed);
+
+    if (auto* currentHandler = handler.load(std::memory_order_acquire))
+        currentHandler(type, function);
+
+    if (abortOnViolation.load(std::memory_order_relaxed))
+        std::abort();
+}
+
+void RealtimeSafety::setHandler(Handler newHandler) noexcept
+{
+    handler.store(newHandler, std::memory_order_release);
+}
+
+void RealtimeSafety::setAbortOnViolation(bool shouldAbort) noexcept
+{
+    abortOnViolation.store(shouldAbort, std::memory_order_relaxed);
+}
+
+int64_t RealtimeSafety::getNumViolations() noexcept
+{
+    return numViolations.load(std::memory_order_relaxed);
+}
+
+void RealtimeSafety::resetViolations() noexcept
+{
+    numViolations.store(0, std::memory_order_relaxed);
+}
+
+const char* RealtimeSafety::getName(ViolationType type) noexcept
+{
+    switch (type)
+    {
+        case VIOLATION_ALLOCATION:      return "allocation";
+        case VIOLATION_DEALLOCATION:    return "deallocation";
+        case VIOLATION_LOCK:            return "lock";
+        case VIOLATION_BLOCKING_CALL:   return "blocking call";
+        default:                        return "unknown";
+    }
+}
+
+#endif
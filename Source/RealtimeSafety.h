@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.h
+    Debug/test mode that marks the audio thread while it is inside
+    processBlock, so allocations, locks and blocking system calls made from
+    it can be caught. Compiled in with EQ_REALTIME_SAFETY_CHECKS=1, otherwise
+    the scopes are empty and cost nothing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#ifndef EQ_REALTIME_SAFETY_CHECKS
+ #define EQ_REALTIME_SAFETY_CHECKS 0
+#endif
+
+/**
+    Only the marking lives in the plugin. The interception is done by the
+    tools, which replace malloc/free, the pthread locks and the blocking
+    system calls for the whole executable (see
+    Tools/Common/RealtimeSafetyHooks.cpp), and ask isInRealtimeContext()
+    before forwarding each call. A plugin build with the checks on marks
+    its thread just the same, but nothing is intercepted there.
+*/
+namespace RealtimeSafety
+{
+    enum ViolationType
+    {
+        VIOLATION_ALLOCATION,
+        VIOLATION_DEALLOCATION,
+        VIOLATION_LOCK,
+        VIOLATION_BLOCKING_CALL
+    };
+
+   #if EQ_REALTIME_SAFETY_CHECKS
+
+    // Marks the calling thread as realtime for the scope, does nothing if isRealtime is false. Nests.
+    class ScopedRealtimeContext
+    {
+    public:
+        explicit ScopedRealtimeContext(bool isRealtime = true) noexcept;
+        ~ScopedRealtimeContext() noexcept;
+
+    private:
+        const bool active;
+    };
+
+    // Lifts the checks for the scope, for the reporting itself and anything that is allowed to block
+    class ScopedAllowance
+    {
+    public:
+        ScopedAllowance() noexcept;
+        ~ScopedAllowance() noexcept;
+    };
+
+    // True inside a ScopedRealtimeContext and outside any ScopedAllowance. Never allocates, safe to call from malloc.
+    bool isInRealtimeContext() noexcept;
+
+    // Called by the interceptors: counts the violation and passes it to the handler
+    void reportViolation(ViolationType type, const char* function) noexcept;
+
+    // The default handler prints the first few violations with a stack trace to stderr.
+    // A handler runs inside a ScopedAllowance, so it can allocate and print.
+    using Handler = void (*)(ViolationType type, const char* function);
+    void setHandler(Handler newHandler) noexcept;
+
+    // Aborts after reporting, so a debugger stops right on the offending call
+    void setAbortOnViolation(bool shouldAbort) noexcept;
+
+    int64_t getNumViolations() noexcept;
+    void resetViolations() noexcept;
+
+    const char* getName(ViolationType type) noexcept;
+
+   #else
+
+    struct ScopedRealtimeContext
+    {
+        explicit ScopedRealtimeContext(bool = true) noexcept {}
+    };
+
+    struct ScopedAllowance
+    {
+        ScopedAllowance() noexcept {}
+    };
+
+    inline bool isInRealtimeContext() noexcept { return false; }
+
+   #endif
+}
@@ -0,0 +1,241 @@
+/*
+  ==============================================================================
+
+    ResponseCurve.cpp
+
+  ==============================================================================
+*/
+
+#include "ResponseCurve.h"
+#include "PluginProcessor.h"
+
+//==============================================================================
+ResponseCurve::ResponseCurve()
+{
+    frequencies.resize((size_t) numPoints);
+
+    for (int point = 0; point < numPoints; ++point)
+        frequencies[(size_t) point] = minFrequency * std::pow((double) maxFrequency / minFrequency, (double) point / (numPoints - 1));
+
+    for (auto* band : { &lowCut, &peak, &highCut })
+    {
+        band->numerator.resize((size_t) numRegisters);
+        band->denominator.resize((size_t) numRegisters);
+    }
+
+    basePhi.resize((size_t) numRegisters);
+    oversampledPhi.resize((size_t) numRegisters);
+    decibels.resize((size_t) numPoints);
+}
+
+bool ResponseCurve::update(const ChainSettings& chainSettings, double sampleRate, int oversamplingFactor)
+{
+    auto changedBands = getChangedBands(lastSettings, chainSettings);
+
+    if (sampleRate != lastSampleRate || oversamplingFactor != lastOversamplingFactor)
+    {
+        fillPhi(basePhi, sampleRate);
+        fillPhi(oversampledPhi, sampleRate * oversamplingFactor);
+
+        lastSampleRate = sampleRate;
+        lastOversamplingFactor = oversamplingFactor;
+        changedBands = ALL_BANDS;
+    }
+
+    if (changedBands == 0)
+        return false;
+
+    lastSettings = chainSettings;
+    designCoefficients(coefficientSet, chainSettings, sampleRate, changedBands, oversamplingFactor, true);
+
+    if (changedBands & LOW_CUT_BAND)
+    {
+        lowCut.reset();
+
+        for (int i = 0; i < coefficientSet.numLowCutStages; ++i)
+            lowCut.addStage(coefficientSet.lowCut[(size_t) i], basePhi);
+    }
+
+    if (changedBands & PEAK_BAND)
+    {
+        peak.reset();
+        peak.addStage(coefficientSet.peak, oversampledPhi);
+    }
+
+    if (changedBands & HIGH_CUT_BAND)
+    {
+        highCut.reset();
+
+        for (int i = 0; i < coefficientSet.numHighCutStages; ++i)
+            highCut.addStage(coefficientSet.highCut[(size_t) i], oversampledPhi);
+    }
+
+    // combine the bands, the one division and log per point happen here
+    for (int r = 0; r < numRegisters; ++r)
+    {
+        const auto numerator = lowCut.numerator[(size_t) r] * peak.numerator[(size_t) r] * highCut.numerator[(size_t) r];
+        const auto denominator = lowCut.denominator[(size_t) r] * peak.denominator[(size_t) r] * highCut.denominator[(size_t) r];
+
+        for (size_t lane = 0; lane < Register::SIMDNumElements; ++lane)
+        {
+            const auto magnitudeSquared = numerator.get(lane) / juce::jmax(denominator.get(lane), 1.0e-300);
+            decibels[(size_t) r * Register::SIMDNumElements + lane] = (float) (10.0 * std::log10(juce::jmax(magnitudeSquared, 1.0e-30)));
+        }
+    }
+
+    ++generation;
+    return true;
+}
+
+void ResponseCurve::fillPhi(std::vector<Register>& phi, double rate) const
+{
+    for (int point = 0; point < numPoints; ++point)
+    {
+        // points above Nyquist (only possible at very low rates) are clamped to it
+        const auto halfOmega = juce::MathConstants<double>::pi * juce::jmin(frequencies[(size_t) point], rate * 0.5) / rate;
+        const auto sine = std::sin(halfOmega);
+
+        phi[(size_t) point / Register::SIMDNumElements].set((size_t) point % Register::SIMDNumElements, sine * sine);
+    }
+}
+
+//==============================================================================
+void ResponseCurve::BandResponse::reset() noexcept
+{
+    std::fill(numerator.begin(), numerator.end(), Register::expand(1.0));
+    std::fill(denominator.begin(), denominator.end(), Register::expand(1.0));
+}
+
+void ResponseCurve::BandResponse::addStage(const BiquadCoefficients& coefficients, const std::vector<Register>& phi) noexcept
+{
+    const auto b0 = (double) coefficients.b0, b1 = (double) coefficients.b1, b2 = (double) coefficients.b2;
+    const auto a1 = (double) coefficients.a1, a2 = (double) coefficients.a2;
+
+    const auto n0 = Register::expand((b0 + b1 + b2) * (b0 + b1 + b2));
+    const auto n1 = Register::expand(4.0 * (b0 * b1 + 4.0 * b0 * b2 + b1 * b2));
+    const auto n2 = Register::expand(16.0 * b0 * b2);
+
+    const auto d0 = Register::expand((1.0 + a1 + a2) * (1.0 + a1 + a2));
+    const auto d1 = Register::expand(4.0 * (a1 + 4.0 * a2 + a1 * a2));
+    const auto d2 = Register::expand(16.0 * a2);
+
+    for (size_t r = 0; r < phi.size(); ++r)
+    {
+        const auto p = phi[r];
+        numerator[r] *= n0 - p * (n1 - p * n2);
+        denominator[r] *= d0 - p * (d1 - p * d2);
+    }
+}
+
+//==============================================================================
+ResponseCurveDisplay::ResponseCurveDisplay(_3BandEQTutorialAudioProcessor& processorToShow)
+    : processor(processorToShow)
+{
+    setInterceptsMouseClicks(false, false);
+    setBufferedToImage(true);
+}
+
+bool ResponseCurveDisplay::refresh()
+{
+    // before prepareToPlay there is no rate yet, so draw the curve as it would be at 48 kHz
+    const auto sampleRate = processor.getSampleRate() > 0 ? processor.getSampleRate() : 48000.0;
+
+    if (!curve.update(processor.getCurrentChainSettings(), sampleRate, processor.getSelectedOversamplingFactor()))
+        return false;
+
+    // the strip the old curve covered plus the one the new curve covers, the rest of the layer stays cached
+    const auto oldArea = getPathArea();
+    rebuildPath();
+    repaint(oldArea.getUnion(getPathArea()));
+
+    return true;
+}
+
+void ResponseCurveDisplay::resized()
+{
+    rebuildPath();
+}
+
+juce::Rectangle<int> ResponseCurveDisplay::getPathArea() const
+{
+    return path.getBounds().getSmallestIntegerContainer().expanded(2);
+}
+
+void ResponseCurveDisplay::rebuildPath()
+{
+    path.clear();
+
+    const auto bounds = getLocalBounds().toFloat();
+    const auto& decibels = curve.getDecibels();
+
+    for (int point = 0; point < ResponseCurve::numPoints; ++point)
+    {
+        const auto x = bounds.getX() + bounds.getWidth() * (float) point / (float) (ResponseCurve::numPoints - 1);
+        const auto y = juce::jmap(juce::jlimit(-decibelRange, decibelRange, decibels[(size_t) point]),
+                                  decibelRange, -decibelRange, bounds.getY(), bounds.getBottom());
+
+        if (point == 0)
+            path.startNewSubPath(x, y);
+        else
+            path.lineTo(x, y);
+    }
+}
+
+void ResponseCurveDisplay::paint(juce::Graphics& g)
+{
+    g.setColour(juce::Colours::white);
+    g.strokePath(path, juce::PathStrokeType(2.0f));
+}
+
+//==============================================================================
+ResponseGrid::ResponseGrid()
+{
+    setInterceptsMouseClicks(false, false);
+    setOpaque(true);
+    setBufferedToImage(true);
+}
+
+void ResponseGrid::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colours::black);
+
+    const auto bounds = getLocalBounds().toFloat();
+    const auto decibelRange = ResponseCurveDisplay::decibelRange;
+
+    auto getX = [&](float frequency)
+    {
+        return bounds.getX() + bounds.getWidth() * std::log(frequency / ResponseCurve::minFrequency)
+                                                 / std::log(ResponseCurve::maxFrequency / ResponseCurve::minFrequency);
+    };
+
+    auto getY = [&](float decibels) { return juce::jmap(decibels, decibelRange, -decibelRange, bounds.getY(), bounds.getBottom()); };
+
+    g.setFont(juce::FontOptions(11.0f));
+
+    // decades brighter, with labels, the steps in between fainter
+    for (auto frequency : { 50.0f, 100.0f, 200.0f, 500.0f, 1000.0f, 2000.0f, 5000.0f, 10000.0f })
+    {
+        const auto isDecade = frequency == 100.0f || frequency == 1000.0f || frequency == 10000.0f;
+        const auto x = getX(frequency);
+
+        g.setColour(juce::Colours::white.withAlpha(isDecade ? 0.12f : 0.05f));
+        g.drawVerticalLine(juce::roundToInt(x), bounds.getY(), bounds.getBottom());
+
+        g.setColour(juce::Colours::white.withAlpha(0.4f));
+        g.drawText(frequency >= 1000.0f ? juce::String(frequency / 1000.0f) + "k" : juce::String(frequency),
+                   juce::Rectangle<float>(x + 2.0f, bounds.getBottom() - 14.0f, 40.0f, 14.0f), juce::Justification::centredLeft);
+    }
+
+    // the response curve's level scale, 0 dB brighter
+    for (auto decibels : { -decibelRange / 2, 0.0f, decibelRange / 2 })
+    {
+        const auto y = getY(decibels);
+
+        g.setColour(juce::Colours::white.withAlpha(decibels == 0.0f ? 0.2f : 0.05f));
+        g.drawHorizontalLine(juce::roundToInt(y), bounds.getX(), bounds.getRight());
+
+        g.setColour(juce::Colours::white.withAlpha(0.4f));
+        g.drawText((decibels > 0 ? "+" : "") + juce::String(decibels, 0) + " dB",
+                   juce::Rectangle<float>(bounds.getRight() - 46.0f, y - 14.0f, 44.0f, 14.0f), juce::Justification::centredRight);
+    }
+}
@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+    ResponseCurve.h
+    Magnitude response of the whole chain for the editor, evaluated with
+    SIMD over a fixed set of log spaced frequencies and cached per band.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "CoefficientDesigner.h"
+
+class _3BandEQTutorialAudioProcessor;
+
+
+//==============================================================================
+/**
+    Each band keeps the product of its stages' |B|^2 and |A|^2 at every
+    frequency point. update() works out which bands moved with the same
+    BandMask the designer uses and only re-evaluates those, then combines
+    the three bands and bumps the generation.
+
+    Every stage is evaluated as
+        |H|^2 = (n0 - n1 phi + n2 phi^2) / (d0 - d1 phi + d2 phi^2),  phi = sin^2(w / 2)
+    which only needs multiplies and adds per point, so whole SIMD registers
+    of points go through at once. It's done in double, because around 20 Hz
+    the cut sections' denominators are tiny and float loses them.
+*/
+class ResponseCurve
+{
+public:
+    using Register = juce::dsp::SIMDRegister<double>;
+
+    static constexpr int numPoints = 1024;
+    static constexpr float minFrequency = 20.0f, maxFrequency = 20000.0f;
+
+    ResponseCurve();
+
+    // Returns true if the curve changed, i.e. the generation moved on
+    bool update(const ChainSettings& chainSettings, double sampleRate, int oversamplingFactor = 1);
+
+    juce::uint32 getGeneration() const noexcept { return generation; }
+
+    // Frequency of each point, spaced evenly on a log axis from minFrequency to maxFrequency
+    double getFrequency(int point) const noexcept { return frequencies[(size_t) point]; }
+
+    const std::vector<float>& getDecibels() const noexcept { return decibels; }
+
+private:
+    static constexpr int numRegisters = numPoints / (int) Register::SIMDNumElements;
+    static_assert(numPoints % (int) Register::SIMDNumElements == 0, "points have to fill whole registers");
+
+    struct BandResponse
+    {
+        std::vector<Register> numerator, denominator;
+
+        void reset() noexcept;
+        void addStage(const BiquadCoefficients& coefficients, const std::vector<Register>& phi) noexcept;
+    };
+
+    void fillPhi(std::vector<Register>& phi, double rate) const;
+
+    std::vector<double> frequencies;
+    std::vector<Register> basePhi, oversampledPhi;
+
+    BandResponse lowCut, peak, highCut;
+
+    CoefficientSet coefficientSet;
+    ChainSettings lastSettings;
+    double lastSampleRate{ 0 };
+    int lastOversamplingFactor{ 0 };
+
+    std::vector<float> decibels;
+    juce::uint32 generation{ 0 };
+};
+
+
+//==============================================================================
+/**
+    Draws the processor's response curve on a transparent background. The
+    editor calls refresh() once per frame, and only the area the old and
+    new curve cover gets repainted. The curve layer is buffered to an
+    image, so a spectrum frame repainting underneath it only composites
+    the image instead of stroking the path again.
+*/
+class ResponseCurveDisplay : public juce::Component
+{
+public:
+    explicit ResponseCurveDisplay(_3BandEQTutorialAudioProcessor& processor);
+
+    static constexpr float decibelRange = 24.0f;
+
+    // Message thread, returns true if the curve changed
+    bool refresh();
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+private:
+    void rebuildPath();
+    juce::Rectangle<int> getPathArea() const;
+
+    _3BandEQTutorialAudioProcessor& processor;
+    ResponseCurve curve;
+    juce::Path path;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ResponseCurveDisplay)
+};
+
+
+//==============================================================================
+/**
+    The static layer under the spectrum and the response curve: background,
+    frequency and level grid and their labels. Opaque and buffered to an
+    image, so it is only drawn again when the editor is resized.
+*/
+class ResponseGrid : public juce::Component
+{
+public:
+    ResponseGrid();
+
+    void paint(juce::Graphics& g) override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ResponseGrid)
+};
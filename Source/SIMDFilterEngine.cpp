@@ -0,0 +1,358 @@
+/*
+  ==============================================================================
+
+    SIMDFilterEngine.cpp
+
+  ==============================================================================
+*/
+
+#include "SIMDFilterEngine.h"
+
+//==============================================================================
+size_t SIMDFilterEngine::getArenaBytes(const juce::dsp::ProcessSpec& spec) noexcept
+{
+    const auto numSpecGroups = ((int) spec.numChannels + numLanes - 1) / numLanes;
+
+    return FilterArena::align(sizeof(ChannelGroup) * (size_t) numSpecGroups)
+         + FilterArena::align(sizeof(Register) * (size_t) spec.maximumBlockSize);
+}
+
+void SIMDFilterEngine::prepare(const juce::dsp::ProcessSpec& spec, Topology newTopology, FilterArena* sharedArena)
+{
+    static_assert(std::is_trivially_destructible<ChannelGroup>::value, "groups live in the raw arena and are never destroyed");
+    static_assert(alignof(ChannelGroup) <= FilterArena::alignment && alignof(Register) <= FilterArena::alignment,
+                  "arena pieces are only cache-line aligned");
+
+    numChannels = (int) spec.numChannels;
+    topology = newTopology;
+    numGroups = (numChannels + numLanes - 1) / numLanes;
+    maximumBlockSize = (size_t) spec.maximumBlockSize;
+
+    // the groups (coefficients + state), then the interleave frames
+    auto* arena = sharedArena;
+
+    if (arena == nullptr)
+    {
+        arena = &ownArena;
+        ownArena.reset(getArenaBytes(spec));
+    }
+    else
+    {
+        ownArena.reset(0);
+    }
+
+    groups = static_cast<ChannelGroup*>(arena->allocate(sizeof(ChannelGroup) * (size_t) numGroups));
+    frames = static_cast<Register*>(arena->allocate(sizeof(Register) * maximumBlockSize));
+
+    for (int g = 0; g < numGroups; ++g)
+    {
+        auto& group = *new (groups + g) ChannelGroup();
+        group.numUsedLanes = juce::jmin(numLanes, numChannels - g * numLanes);
+        group.topology = topology;
+
+        for (int lane = 0; lane < numLanes; ++lane)
+            group.setCoefficients(lane, {}, ALL_BANDS);
+    }
+
+    reset();
+}
+
+void SIMDFilterEngine::reset() noexcept
+{
+    for (int g = 0; g < numGroups; ++g)
+        groups[g].reset();
+}
+
+void SIMDFilterEngine::copyFrom(const SIMDFilterEngine& other) noexcept
+{
+    jassert(other.numGroups == numGroups && other.topology == topology);
+
+    std::copy(other.groups, other.groups + juce::jmin(numGroups, other.numGroups), groups);
+}
+
+void SIMDFilterEngine::setCoefficients(const CoefficientSet& coefficientSet, int bands) noexcept
+{
+    for (int g = 0; g < numGroups; ++g)
+        for (int lane = 0; lane < numLanes; ++lane)
+            groups[g].setCoefficients(lane, coefficientSet, bands);
+}
+
+void SIMDFilterEngine::setCoefficients(int channel, const CoefficientSet& coefficientSet, int bands) noexcept
+{
+    jassert(juce::isPositiveAndBelow(channel, numChannels));
+
+    groups[channel / numLanes].setCoefficients(channel % numLanes, coefficientSet, bands);
+}
+
+void SIMDFilterEngine::process(const juce::dsp::AudioBlock<float>& block, const float* peakModulation) noexcept
+{
+    const auto numSamples = block.getNumSamples();
+    const auto channelsToProcess = juce::jmin((int) block.getNumChannels(), numChannels);
+
+    jassert(numSamples <= maximumBlockSize);
+
+    auto* samples = reinterpret_cast<float*>(frames);
+
+    for (int firstChannel = 0; firstChannel < channelsToProcess; firstChannel += numLanes)
+    {
+        const auto channelsInGroup = juce::jmin(numLanes, channelsToProcess - firstChannel);
+
+        // interleave the group so each sample frame is one register, spare lanes stay silent
+        if (channelsInGroup < numLanes)
+            std::fill(samples, samples + numSamples * numLanes, 0.0f);
+
+        for (int lane = 0; lane < channelsInGroup; ++lane)
+        {
+            auto* source = block.getChannelPointer((size_t) (firstChannel + lane));
+
+            for (size_t i = 0; i < numSamples; ++i)
+                samples[i * numLanes + (size_t) lane] = source[i];
+        }
+
+        auto& group = groups[firstChannel / numLanes];
+        group.cascade(group, frames, numSamples);
+
+        if (peakModulation != nullptr)
+        {
+            if (group.topology == STATE_VARIABLE)
+                processDynamicStage<STATE_VARIABLE>(group, frames, numSamples, peakModulation);
+            else
+                processDynamicStage<DIRECT_FORM>(group, frames, numSamples, peakModulation);
+        }
+
+        for (int lane = 0; lane < channelsInGroup; ++lane)
+        {
+            auto* destination = block.getChannelPointer((size_t) (firstChannel + lane));
+
+            for (size_t i = 0; i < numSamples; ++i)
+                destination[i] = samples[i * numLanes + (size_t) lane];
+        }
+    }
+}
+
+bool SIMDFilterEngine::hasDecayingState(float threshold) const noexcept
+{
+    for (int g = 0; g < numGroups; ++g)
+        for (auto& stage : groups[g].stages)
+            for (size_t lane = 0; lane < (size_t) groups[g].numUsedLanes; ++lane)
+                for (auto state : { stage.s1.get(lane), stage.s2.get(lane) })
+                    if (state != 0.0f && std::abs(state) < threshold)
+                        return true;
+
+    return false;
+}
+
+float SIMDFilterEngine::getStateMagnitude() const noexcept
+{
+    auto magnitude = 0.0f;
+
+    for (int g = 0; g < numGroups; ++g)
+        for (auto& stage : groups[g].stages)
+            for (size_t lane = 0; lane < (size_t) groups[g].numUsedLanes; ++lane)
+                magnitude = juce::jmax(magnitude, std::abs(stage.s1.get(lane)), std::abs(stage.s2.get(lane)));
+
+    return magnitude;
+}
+
+//==============================================================================
+void SIMDFilterEngine::ChannelGroup::setStage(int stageIndex, int lane, const BiquadCoefficients& coefficients) noexcept
+{
+    auto& stage = stages[(size_t) stageIndex];
+    stage.c0.set((size_t) lane, coefficients.b0);
+    stage.c1.set((size_t) lane, coefficients.b1);
+    stage.c2.set((size_t) lane, coefficients.b2);
+    stage.c3.set((size_t) lane, coefficients.a1);
+    stage.c4.set((size_t) lane, coefficients.a2);
+}
+
+void SIMDFilterEngine::ChannelGroup::setStage(int stageIndex, int lane, const SVFCoefficients& coefficients) noexcept
+{
+    auto& stage = stages[(size_t) stageIndex];
+    stage.c0.set((size_t) lane, coefficients.a1);
+    stage.c1.set((size_t) lane, coefficients.a2);
+    stage.c2.set((size_t) lane, coefficients.a3);
+    stage.c3.set((size_t) lane, coefficients.m0);
+    stage.c4.set((size_t) lane, coefficients.m1);
+    stage.c5.set((size_t) lane, coefficients.m2);
+}
+
+void SIMDFilterEngine::ChannelGroup::setCoefficients(int lane, const CoefficientSet& coefficientSet, int bands) noexcept
+{
+    jassert(juce::isPositiveAndBelow(lane, numLanes));
+
+    // skipped cut sections simply have no stages, a skipped peak becomes an identity biquad
+    const auto lowCutStagesUsed = (bands & LOW_CUT_BAND) != 0 ? coefficientSet.numLowCutStages : 0;
+    const auto highCutStagesUsed = (bands & HIGH_CUT_BAND) != 0 ? coefficientSet.numHighCutStages : 0;
+
+    if (topology == STATE_VARIABLE)
+        setBands(lane, coefficientSet.lowCutSVF, coefficientSet.peakSVF, coefficientSet.peakBandPassSVF, coefficientSet.highCutSVF,
+                 lowCutStagesUsed, highCutStagesUsed, (bands & PEAK_BAND) != 0);
+    else
+        setBands(lane, coefficientSet.lowCut, coefficientSet.peak, coefficientSet.peakBandPass, coefficientSet.highCut,
+                 lowCutStagesUsed, highCutStagesUsed, (bands & PEAK_BAND) != 0);
+
+    numLowCutStages[(size_t) lane] = lowCutStagesUsed;
+    numHighCutStages[(size_t) lane] = highCutStagesUsed;
+    updateCascade();
+}
+
+template <typename Coefficients, typename CutStages>
+void SIMDFilterEngine::ChannelGroup::setBands(int lane, const CutStages& lowCut, const Coefficients& peak, const Coefficients& peakBandPass,
+                                              const CutStages& highCut, int lowCutStagesUsed, int highCutStagesUsed, bool usePeak) noexcept
+{
+    // default constructed coefficients are identity in both topologies
+    for (int i = 0; i < CoefficientSet::maxCutStages; ++i)
+    {
+        setStage(firstLowCutSlot + i, lane, i < lowCutStagesUsed ? lowCut[(size_t) i] : Coefficients{});
+        setStage(firstHighCutSlot + i, lane, i < highCutStagesUsed ? highCut[(size_t) i] : Coefficients{});
+    }
+
+    setStage(peakSlot, lane, usePeak ? peak : Coefficients{});
+
+    // without the peak the band pass outputs nothing, rather than the identity the other slots fall back to
+    auto silent = Coefficients{};
+
+    if constexpr (std::is_same<Coefficients, BiquadCoefficients>::value)
+        silent.b0 = 0.0f;
+    else
+        silent.m0 = 0.0f;
+
+    setStage(dynamicSlot, lane, usePeak ? peakBandPass : silent);
+}
+
+void SIMDFilterEngine::ChannelGroup::updateCascade() noexcept
+{
+    int maxLowCutStages = 0, maxHighCutStages = 0;
+
+    for (int lane = 0; lane < numUsedLanes; ++lane)
+    {
+        maxLowCutStages = juce::jmax(maxLowCutStages, numLowCutStages[(size_t) lane]);
+        maxHighCutStages = juce::jmax(maxHighCutStages, numHighCutStages[(size_t) lane]);
+    }
+
+    cascade = getCascade(topology, maxLowCutStages, maxHighCutStages);
+}
+
+void SIMDFilterEngine::ChannelGroup::reset() noexcept
+{
+    for (auto& stage : stages)
+        stage.s1 = stage.s2 = Register::expand(0.0f);
+}
+
+//==============================================================================
+template <SIMDFilterEngine::Topology StageTopology, int Slot>
+void SIMDFilterEngine::processStage(ChannelGroup& group, Register* frames, size_t numSamples) noexcept
+{
+    // one pass per stage keeps the coefficients and state in registers for the whole block
+    auto& stage = group.stages[Slot];
+    auto s1 = stage.s1, s2 = stage.s2;
+
+    if constexpr (StageTopology == STATE_VARIABLE)
+    {
+        // s1 and s2 are the two integrators' trapezoidal state
+        const auto a1 = stage.c0, a2 = stage.c1, a3 = stage.c2, m0 = stage.c3, m1 = stage.c4, m2 = stage.c5;
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const auto x = frames[i];
+            const auto v3 = x - s2;
+            const auto v1 = a1 * s1 + a2 * v3;
+            const auto v2 = s2 + a2 * s1 + a3 * v3;
+            s1 = v1 + v1 - s1;
+            s2 = v2 + v2 - s2;
+            frames[i] = m0 * x + m1 * v1 + m2 * v2;
+        }
+    }
+    else
+    {
+        const auto b0 = stage.c0, b1 = stage.c1, b2 = stage.c2, a1 = stage.c3, a2 = stage.c4;
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const auto x = frames[i];
+            const auto y = b0 * x + s1;
+            s1 = b1 * x - a1 * y + s2;
+            s2 = b2 * x - a2 * y;
+            frames[i] = y;
+        }
+    }
+
+    stage.s1 = s1;
+    stage.s2 = s2;
+}
+
+template <SIMDFilterEngine::Topology StageTopology>
+void SIMDFilterEngine::processDynamicStage(ChannelGroup& group, Register* frames, size_t numSamples, const float* modulation) noexcept
+{
+    // the same band pass as either topology's stage, but mixed back in with a gain that can move every sample,
+    // so a dynamic gain never means redesigning coefficients
+    auto& stage = group.stages[dynamicSlot];
+    auto s1 = stage.s1, s2 = stage.s2;
+
+    if constexpr (StageTopology == STATE_VARIABLE)
+    {
+        const auto a1 = stage.c0, a2 = stage.c1, a3 = stage.c2, m0 = stage.c3, m1 = stage.c4, m2 = stage.c5;
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const auto x = frames[i];
+            const auto v3 = x - s2;
+            const auto v1 = a1 * s1 + a2 * v3;
+            const auto v2 = s2 + a2 * s1 + a3 * v3;
+            s1 = v1 + v1 - s1;
+            s2 = v2 + v2 - s2;
+            frames[i] = x + (m0 * x + m1 * v1 + m2 * v2) * modulation[i];
+        }
+    }
+    else
+    {
+        const auto b0 = stage.c0, b1 = stage.c1, b2 = stage.c2, a1 = stage.c3, a2 = stage.c4;
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const auto x = frames[i];
+            const auto y = b0 * x + s1;
+            s1 = b1 * x - a1 * y + s2;
+            s2 = b2 * x - a2 * y;
+            frames[i] = x + y * modulation[i];
+        }
+    }
+
+    stage.s1 = s1;
+    stage.s2 = s2;
+}
+
+template <SIMDFilterEngine::Topology StageTopology, int FirstSlot, int... Offsets>
+void SIMDFilterEngine::processStages(ChannelGroup& group, Register* frames, size_t numSamples, std::integer_sequence<int, Offsets...>) noexcept
+{
+    (processStage<StageTopology, FirstSlot + Offsets>(group, frames, numSamples), ...);
+}
+
+template <SIMDFilterEngine::Topology StageTopology, int NumLowCutStages, int NumHighCutStages>
+void SIMDFilterEngine::processCascade(ChannelGroup& group, Register* frames, size_t numSamples) noexcept
+{
+    processStages<StageTopology, firstLowCutSlot>(group, frames, numSamples, std::make_integer_sequence<int, NumLowCutStages>());
+    processStage<StageTopology, peakSlot>(group, frames, numSamples);
+    processStages<StageTopology, firstHighCutSlot>(group, frames, numSamples, std::make_integer_sequence<int, NumHighCutStages>());
+}
+
+SIMDFilterEngine::CascadeFunction SIMDFilterEngine::getCascade(Topology topology, int numLowCutStages, int numHighCutStages) noexcept
+{
+    static_assert(CoefficientSet::maxCutStages == 4, "the cascade table below needs updating");
+
+   #define EQ_CASCADE_ROW(topology, numLowCut) { &processCascade<topology, numLowCut, 0>, &processCascade<topology, numLowCut, 1>, \
+                                                 &processCascade<topology, numLowCut, 2>, &processCascade<topology, numLowCut, 3>, \
+                                                 &processCascade<topology, numLowCut, 4> }
+   #define EQ_CASCADE_TABLE(topology) { EQ_CASCADE_ROW(topology, 0), EQ_CASCADE_ROW(topology, 1), EQ_CASCADE_ROW(topology, 2), \
+                                        EQ_CASCADE_ROW(topology, 3), EQ_CASCADE_ROW(topology, 4) }
+
+    static constexpr CascadeFunction cascades[2][5][5] = { EQ_CASCADE_TABLE(DIRECT_FORM), EQ_CASCADE_TABLE(STATE_VARIABLE) };
+
+   #undef EQ_CASCADE_TABLE
+   #undef EQ_CASCADE_ROW
+
+    jassert(juce::isPositiveAndNotGreaterThan(numLowCutStages, CoefficientSet::maxCutStages));
+    jassert(juce::isPositiveAndNotGreaterThan(numHighCutStages, CoefficientSet::maxCutStages));
+
+    return cascades[topology][numLowCutStages][numHighCutStages];
+}
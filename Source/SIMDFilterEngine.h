@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    SIMDFilterEngine.h
+    Runs the whole low-cut/peak/high-cut cascade for any number of channels,
+    one channel per lane of a juce::dsp::SIMDRegister.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientDesigner.h"
+#include "FilterArena.h"
+
+
+//==============================================================================
+/**
+    Transposed direct form II biquad cascade with the channels interleaved
+    into SIMD lanes. Every lane carries its own coefficients, so linked stereo
+    and dual-mono settings cost exactly the same.
+
+    Channels are processed in groups of Register::size() (4 with SSE/NEON,
+    8 with AVX), and the number of groups is sized from the real bus layout
+    in prepare(), so 5.1, 7.1.4 or 16 channel ambisonics need no extra work.
+
+    Each slope combination has its own template-instantiated cascade with
+    exactly the stages it needs. The one to run is picked when a slope
+    changes, never per block.
+
+    All coefficients, filter state and the interleave scratch space are
+    carved from a cache-line aligned FilterArena in prepare(). The processor
+    passes its instance arena, so every engine it runs shares one contiguous
+    block of memory; an engine given none keeps an arena of its own.
+
+    The topology is picked in prepare(): direct form biquads are the
+    cheapest, the state variable filters cost a little more per stage but
+    keep very low cutoffs at high sample rates accurate in float.
+*/
+class SIMDFilterEngine
+{
+public:
+    using Register = juce::dsp::SIMDRegister<float>;
+
+    // both cut sections, the peak, and the peak's dynamic band pass
+    static constexpr int maxStages = CoefficientSet::maxCutStages * 2 + 2;
+
+    static constexpr int numLanes = (int) Register::size();
+
+    enum Topology
+    {
+        DIRECT_FORM,    // transposed direct form II biquads
+        STATE_VARIABLE  // TPT state variable filters
+    };
+
+    // Bytes prepare() carves from the arena for this spec
+    static size_t getArenaBytes(const juce::dsp::ProcessSpec& spec) noexcept;
+
+    // Not realtime safe. With sharedArena the memory comes from there, and the engine must be prepared again
+    // whenever that arena is reset.
+    void prepare(const juce::dsp::ProcessSpec& spec, Topology topology = DIRECT_FORM, FilterArena* sharedArena = nullptr);
+    void reset() noexcept;
+
+    // Copies coefficients and filter state from an engine prepared with the same spec and topology
+    void copyFrom(const SIMDFilterEngine& other) noexcept;
+
+    // Applies the same coefficients to every lane (linked stereo).
+    // Only the bands in the BandMask are run, the others are skipped or left as identity.
+    void setCoefficients(const CoefficientSet& coefficientSet, int bands = ALL_BANDS) noexcept;
+
+    // Applies coefficients to a single channel (dual-mono)
+    void setCoefficients(int channel, const CoefficientSet& coefficientSet, int bands = ALL_BANDS) noexcept;
+
+    int getNumChannels() const noexcept { return numChannels; }
+    Topology getTopology() const noexcept { return topology; }
+
+    // Bytes used by this instance, its own arena included but not a shared one
+    size_t getMemoryFootprint() const noexcept { return sizeof(*this) + ownArena.getSize(); }
+
+    // With peakModulation, the peak's band pass is added to the output scaled by one value per sample
+    // (the dynamic gain minus one), after the rest of the cascade. Only meaningful on the engine running the peak.
+    void process(const juce::dsp::AudioBlock<float>& block, const float* peakModulation = nullptr) noexcept;
+
+    // True if any filter state is non-zero but below threshold, i.e. ringing down towards the denormal range
+    bool hasDecayingState(float threshold = 1.0e-30f) const noexcept;
+
+    // Largest absolute filter state across the used lanes, 0 once the cascade has fully settled
+    float getStateMagnitude() const noexcept;
+
+private:
+    // Fixed-size record per stage: the coefficients, then the state they run on.
+    // Direct form keeps b0 b1 b2 a1 a2 in c0-c4, the state variable filter a1 a2 a3 m0 m1 m2 in c0-c5.
+    struct Stage
+    {
+        Register c0, c1, c2, c3, c4, c5;
+        Register s1, s2;
+    };
+
+    // slots are fixed per section, lanes that need fewer cut stages get identity biquads in the spare slots
+    enum StageSlots
+    {
+        firstLowCutSlot = 0,
+        peakSlot = CoefficientSet::maxCutStages,
+        firstHighCutSlot = peakSlot + 1,
+        dynamicSlot = firstHighCutSlot + CoefficientSet::maxCutStages
+    };
+
+    struct ChannelGroup;
+    using CascadeFunction = void (*)(ChannelGroup&, Register*, size_t) noexcept;
+
+    struct ChannelGroup
+    {
+        std::array<Stage, maxStages> stages;
+
+        std::array<int, numLanes> numLowCutStages{}, numHighCutStages{};
+        int numUsedLanes{ 0 };
+        Topology topology{ DIRECT_FORM };
+
+        // cascade specialised for the largest slopes used by any lane
+        CascadeFunction cascade{ nullptr };
+
+        void setStage(int stageIndex, int lane, const BiquadCoefficients& coefficients) noexcept;
+        void setStage(int stageIndex, int lane, const SVFCoefficients& coefficients) noexcept;
+        void setCoefficients(int lane, const CoefficientSet& coefficientSet, int bands) noexcept;
+
+        template <typename Coefficients, typename CutStages>
+        void setBands(int lane, const CutStages& lowCut, const Coefficients& peak, const Coefficients& peakBandPass,
+                      const CutStages& highCut, int lowCutStagesUsed, int highCutStagesUsed, bool usePeak) noexcept;
+        void updateCascade() noexcept;
+        void reset() noexcept;
+    };
+
+    template <Topology StageTopology, int Slot>
+    static void processStage(ChannelGroup& group, Register* frames, size_t numSamples) noexcept;
+
+    template <Topology StageTopology, int FirstSlot, int... Offsets>
+    static void processStages(ChannelGroup& group, Register* frames, size_t numSamples, std::integer_sequence<int, Offsets...>) noexcept;
+
+    template <Topology StageTopology, int NumLowCutStages, int NumHighCutStages>
+    static void processCascade(ChannelGroup& group, Register* frames, size_t numSamples) noexcept;
+
+    static CascadeFunction getCascade(Topology topology, int numLowCutStages, int numHighCutStages) noexcept;
+
+    template <Topology StageTopology>
+    static void processDynamicStage(ChannelGroup& group, Register* frames, size_t numSamples, const float* modulation) noexcept;
+
+    // carved as [ChannelGroup x numGroups][Register x maximumBlockSize], each part cache-line aligned
+    FilterArena ownArena;
+    ChannelGroup* groups{ nullptr };
+    Register* frames{ nullptr };
+    int numGroups{ 0 }, numChannels{ 0 };
+    size_t maximumBlockSize{ 0 };
+    Topology topology{ DIRECT_FORM };
+};
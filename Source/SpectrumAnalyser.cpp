@@ -0,0 +1,275 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyser.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyser.h"
+
+//==============================================================================
+SpectrumAnalyser::SpectrumAnalyser() : juce::Thread("EQ Spectrum Analyser")
+{
+    window.resize((size_t) fftSize);
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), window.size(),
+                                                             juce::dsp::WindowingFunction<float>::hann, false);
+}
+
+SpectrumAnalyser::~SpectrumAnalyser()
+{
+    stopThread(1000);
+}
+
+void SpectrumAnalyser::prepare(double newSampleRate)
+{
+    const juce::ScopedLock sl(analysisLock);
+
+    sampleRate = newSampleRate;
+
+    // a quarter of a second is plenty of slack for the analysis thread waking up late
+    const auto fifoSize = juce::jmax(fftSize, juce::roundToInt(sampleRate * 0.25));
+
+    pre.prepare(fifoSize);
+    post.prepare(fifoSize);
+}
+
+void SpectrumAnalyser::setActive(bool shouldBeActive)
+{
+    if (shouldBeActive)
+    {
+        active.store(true);
+        startThread(juce::Thread::Priority::low);
+    }
+    else
+    {
+        active.store(false);
+        stopThread(1000);
+    }
+}
+
+bool SpectrumAnalyser::getPaths(juce::Path& prePath, juce::Path& postPath)
+{
+    const juce::ScopedLock sl(pathLock);
+
+    if (!hasNewPaths)
+        return false;
+
+    prePath = preResult;
+    postPath = postResult;
+    hasNewPaths = false;
+    return true;
+}
+
+void SpectrumAnalyser::run()
+{
+    juce::Path newPre, newPost;
+
+    while (!threadShouldExit())
+    {
+        bool analysed = false;
+
+        {
+            const juce::ScopedLock sl(analysisLock);
+
+            // bitwise or, both taps have to drain their FIFOs every time
+            analysed = pre.analyse(fft, window) | post.analyse(fft, window);
+
+            if (analysed)
+            {
+                pre.buildPath(newPre, sampleRate);
+                post.buildPath(newPost, sampleRate);
+            }
+        }
+
+        if (analysed)
+        {
+            const juce::ScopedLock sl(pathLock);
+            preResult.swapWithPath(newPre);
+            postResult.swapWithPath(newPost);
+            hasNewPaths = true;
+        }
+
+        wait(15);
+    }
+}
+
+//==============================================================================
+void SpectrumAnalyser::Tap::prepare(int fifoSize)
+{
+    fifo.setTotalSize(fifoSize);
+    fifoBuffer.setSize(2, fifoSize);
+    fifoBuffer.clear();
+
+    history.assign((size_t) fftSize, 0.0f);
+    fftData.assign((size_t) fftSize * 2, 0.0f);
+    levels.assign((size_t) fftSize / 2 + 1, minDecibels);
+    samplesSinceLastFFT = 0;
+}
+
+void SpectrumAnalyser::Tap::push(const juce::dsp::AudioBlock<const float>& block) noexcept
+{
+    const auto numChannels = juce::jmin(2, (int) block.getNumChannels());
+
+    if (numChannels == 0 || fifoBuffer.getNumSamples() == 0)
+        return;
+
+    // if the analysis thread falls behind, whatever doesn't fit is dropped
+    const auto scope = fifo.write((int) block.getNumSamples());
+
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        // a mono bus goes into both halves, so the analysis side never has to care
+        auto* source = block.getChannelPointer((size_t) juce::jmin(channel, numChannels - 1));
+
+        if (scope.blockSize1 > 0)
+            fifoBuffer.copyFrom(channel, scope.startIndex1, source, scope.blockSize1);
+
+        if (scope.blockSize2 > 0)
+            fifoBuffer.copyFrom(channel, scope.startIndex2, source + scope.blockSize1, scope.blockSize2);
+    }
+}
+
+bool SpectrumAnalyser::Tap::analyse(juce::dsp::FFT& fftToUse, const std::vector<float>& windowToUse)
+{
+    auto numReady = fifo.getNumReady();
+
+    if (numReady == 0)
+        return false;
+
+    // slide the new samples, summed to mono, into the end of the history
+    {
+        const auto numToKeep = juce::jmax(0, fftSize - numReady);
+        const auto numToSkip = juce::jmax(0, numReady - fftSize);
+
+        std::copy(history.end() - numToKeep, history.end(), history.begin());
+
+        const auto scope = fifo.read(numReady);
+        auto* destination = history.data() + numToKeep;
+        auto position = 0;
+
+        auto copyRange = [&](int start, int size)
+        {
+            for (int i = 0; i < size; ++i, ++position)
+                if (position >= numToSkip)
+                    *destination++ = 0.5f * (fifoBuffer.getSample(0, start + i) + fifoBuffer.getSample(1, start + i));
+        };
+
+        copyRange(scope.startIndex1, scope.blockSize1);
+        copyRange(scope.startIndex2, scope.blockSize2);
+    }
+
+    samplesSinceLastFFT += numReady;
+
+    if (samplesSinceLastFFT < hopSize)
+        return false;
+
+    samplesSinceLastFFT = 0;
+
+    std::fill(fftData.begin(), fftData.end(), 0.0f);
+
+    for (size_t i = 0; i < (size_t) fftSize; ++i)
+        fftData[i] = history[i] * windowToUse[i];
+
+    fftToUse.performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+    // a full scale sine reads 0 dB: the Hann window's coherent gain is 0.5, so scale by 4 / N.
+    // Rises are followed quickly and falls decay slowly, the usual analyser ballistics.
+    for (size_t bin = 0; bin < levels.size(); ++bin)
+    {
+        const auto decibels = juce::Decibels::gainToDecibels(fftData[bin] * 4.0f / (float) fftSize, minDecibels);
+        const auto amount = decibels > levels[bin] ? 0.6f : 0.15f;
+        levels[bin] += amount * (decibels - levels[bin]);
+    }
+
+    return true;
+}
+
+void SpectrumAnalyser::Tap::buildPath(juce::Path& path, double sampleRate) const
+{
+    path.clear();
+
+    const auto topFrequency = juce::jmin((double) maxFrequency, sampleRate * 0.5);
+    const auto logRange = std::log(topFrequency / minFrequency);
+    const auto binsPerHz = fftSize / sampleRate;
+
+    auto toY = [](float decibels) { return juce::jmap(juce::jlimit(minDecibels, maxDecibels, decibels), maxDecibels, minDecibels, 0.0f, 1.0f); };
+
+    // decimate to a fixed number of log spaced points, taking the loudest bin in each point's range
+    // so narrow peaks don't vanish at high frequencies
+    for (int point = 0; point < numPathPoints; ++point)
+    {
+        const auto lowFrequency = minFrequency * std::exp(logRange * point / numPathPoints);
+        const auto highFrequency = minFrequency * std::exp(logRange * (point + 1) / numPathPoints);
+
+        const auto firstBin = juce::jlimit(0, (int) levels.size() - 1, (int) (lowFrequency * binsPerHz));
+        const auto lastBin = juce::jlimit(firstBin, (int) levels.size() - 1, (int) (highFrequency * binsPerHz));
+
+        auto decibels = levels[(size_t) firstBin];
+
+        for (auto bin = firstBin + 1; bin <= lastBin; ++bin)
+            decibels = juce::jmax(decibels, levels[(size_t) bin]);
+
+        const auto x = (float) point / (float) (numPathPoints - 1);
+
+        if (point == 0)
+            path.startNewSubPath(x, toY(decibels));
+        else
+            path.lineTo(x, toY(decibels));
+    }
+}
+
+//==============================================================================
+SpectrumDisplay::SpectrumDisplay(SpectrumAnalyser& analyserToShow)
+    : analyser(analyserToShow)
+{
+    setInterceptsMouseClicks(false, false);
+    analyser.setActive(true);
+}
+
+SpectrumDisplay::~SpectrumDisplay()
+{
+    analyser.setActive(false);
+}
+
+bool SpectrumDisplay::refresh()
+{
+    // silence keeps producing the same flat spectrum, which doesn't need painting again
+    if (!analyser.getPaths(nextPrePath, nextPostPath) || (nextPrePath == prePath && nextPostPath == postPath))
+        return false;
+
+    // swapped rather than copied, so both pairs keep their storage from frame to frame
+    const auto oldArea = getPathArea();
+    prePath.swapWithPath(nextPrePath);
+    postPath.swapWithPath(nextPostPath);
+    repaint(oldArea.getUnion(getPathArea()));
+
+    return true;
+}
+
+juce::AffineTransform SpectrumDisplay::getPathTransform() const
+{
+    const auto bounds = getLocalBounds().toFloat();
+    return juce::AffineTransform::scale(bounds.getWidth(), bounds.getHeight()).translated(bounds.getPosition());
+}
+
+juce::Rectangle<int> SpectrumDisplay::getPathArea() const
+{
+    const auto transform = getPathTransform();
+
+    return prePath.getBoundsTransformed(transform).getUnion(postPath.getBoundsTransformed(transform))
+                  .getSmallestIntegerContainer()
+                  .expanded(2)
+                  .getIntersection(getLocalBounds());
+}
+
+void SpectrumDisplay::paint(juce::Graphics& g)
+{
+    const auto transform = getPathTransform();
+
+    g.setColour(juce::Colours::grey.withAlpha(0.8f));
+    g.strokePath(prePath, juce::PathStrokeType(1.0f), transform);
+
+    g.setColour(juce::Colours::orange);
+    g.strokePath(postPath, juce::PathStrokeType(1.5f), transform);
+}
@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyser.h
+    Pre- and post-EQ spectrum analysis. The audio thread only copies samples
+    into lock-free FIFOs, a background thread does the FFTs and builds the
+    paths the editor draws.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+
+//==============================================================================
+/**
+    Only runs while an editor has it active: with no editor open the push
+    calls return straight away and the analysis thread is stopped.
+
+    Up to the first two channels are captured and summed to mono on the
+    analysis thread, so the audio thread's cost is one copy per channel.
+*/
+class SpectrumAnalyser : private juce::Thread
+{
+public:
+    static constexpr int fftOrder = 12;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int numPathPoints = 256;
+
+    // Frequency range and level range the paths are mapped to
+    static constexpr float minFrequency = 20.0f, maxFrequency = 20000.0f;
+    static constexpr float minDecibels = -90.0f, maxDecibels = 12.0f;
+
+    SpectrumAnalyser();
+    ~SpectrumAnalyser() override;
+
+    // Not realtime safe, call from prepareToPlay
+    void prepare(double sampleRate);
+
+    // Message thread, the editor turns analysis on while it is open
+    void setActive(bool shouldBeActive);
+
+    // Audio thread, wait-free
+    void pushPre(const juce::dsp::AudioBlock<const float>& block) noexcept  { if (active.load(std::memory_order_relaxed)) pre.push(block); }
+    void pushPost(const juce::dsp::AudioBlock<const float>& block) noexcept { if (active.load(std::memory_order_relaxed)) post.push(block); }
+
+    // Message thread. Paths are in unit coordinates: x is log frequency, y is 0 at maxDecibels and 1 at minDecibels.
+    // Returns false if nothing new has been analysed since the last call.
+    bool getPaths(juce::Path& prePath, juce::Path& postPath);
+
+private:
+    static constexpr int hopSize = fftSize / 4;
+
+    // one FIFO and its running analysis per tap point
+    struct Tap
+    {
+        void prepare(int fifoSize);
+        void push(const juce::dsp::AudioBlock<const float>& block) noexcept;
+
+        // analysis thread, returns true if a new spectrum was averaged in
+        bool analyse(juce::dsp::FFT& fft, const std::vector<float>& window);
+        void buildPath(juce::Path& path, double sampleRate) const;
+
+        juce::AbstractFifo fifo{ 1 };
+        juce::AudioBuffer<float> fifoBuffer;
+
+        std::vector<float> history, fftData, levels;
+        int samplesSinceLastFFT{ 0 };
+    };
+
+    void run() override;
+
+    std::atomic<bool> active{ false };
+    Tap pre, post;
+
+    // analysis thread state, also guards prepare() against a running analysis
+    juce::CriticalSection analysisLock;
+    juce::dsp::FFT fft{ fftOrder };
+    std::vector<float> window;
+    double sampleRate{ 0 };
+
+    // finished paths, handed to the message thread under pathLock
+    juce::CriticalSection pathLock;
+    juce::Path preResult, postResult;
+    bool hasNewPaths{ false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalyser)
+};
+
+
+//==============================================================================
+/**
+    Draws the analyser's pre (grey) and post (orange) spectra on a
+    transparent background, over the editor's ResponseGrid. The editor
+    calls refresh() at the rate it wants the spectra to move, and only the
+    area the old and new paths cover gets repainted.
+*/
+class SpectrumDisplay : public juce::Component
+{
+public:
+    explicit SpectrumDisplay(SpectrumAnalyser& analyser);
+    ~SpectrumDisplay() override;
+
+    // Message thread, returns true if a new spectrum came in
+    bool refresh();
+
+    void paint(juce::Graphics& g) override;
+
+private:
+    juce::AffineTransform getPathTransform() const;
+    juce::Rectangle<int> getPathArea() const;
+
+    SpectrumAnalyser& analyser;
+    juce::Path prePath, postPath, nextPrePath, nextPostPath;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumDisplay)
+};
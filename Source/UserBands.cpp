@@ -0,0 +1,354 @@
+/*
+  ==============================================================================
+
+    UserBands.cpp
+
+  ==============================================================================
+*/
+
+#include "UserBands.h"
+
+//==============================================================================
+bool UserBandSettings::isIdentity() const noexcept
+{
+    if (type == USER_BAND_OFF)
+        return true;
+
+    return (type == USER_BAND_PEAK || type == USER_BAND_LOW_SHELF || type == USER_BAND_HIGH_SHELF) && gainInDecibels == 0.0f;
+}
+
+static bool operator==(const UserBandSettings& first, const UserBandSettings& second) noexcept
+{
+    return first.type == second.type && first.frequency == second.frequency
+        && first.gainInDecibels == second.gainInDecibels && first.quality == second.quality;
+}
+
+static bool haveSameTypes(const UserBandArray& first, const UserBandArray& second) noexcept
+{
+    return std::equal(first.begin(), first.end(), second.begin(),
+                      [](const UserBandSettings& a, const UserBandSettings& b) { return a.type == b.type; });
+}
+
+static juce::String getBandParameterID(int band, const char* name)
+{
+    return "Band " + juce::String(band + 1) + " " + name;
+}
+
+void addUserBandParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout, int numBands)
+{
+    for (int band = 0; band < numBands; ++band)
+    {
+        // spread out evenly on a log axis, so switching a band on lands somewhere sensible
+        const auto defaultFrequency = std::round(30.0f * std::pow(16000.0f / 30.0f, (float) band / (float) (numBands - 1)));
+
+        layout.add(std::make_unique<juce::AudioParameterChoice>(getBandParameterID(band, "Type"), getBandParameterID(band, "Type"),
+            juce::StringArray{ "Off", "Peak", "Low Shelf", "High Shelf", "Notch", "Low Cut", "High Cut" }, 0));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(getBandParameterID(band, "Freq"), getBandParameterID(band, "Freq"),
+            juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 0.25f),
+            defaultFrequency));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(getBandParameterID(band, "Gain"), getBandParameterID(band, "Gain"),
+            juce::NormalisableRange<float>(-24.0f, 24.0f, 0.5f),
+            0.0f));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(getBandParameterID(band, "Q"), getBandParameterID(band, "Q"),
+            juce::NormalisableRange<float>(0.10f, 10.0f, 0.05f, 0.25f),
+            1.0f));
+    }
+}
+
+BiquadCoefficients makeUserBandCoefficients(const UserBandSettings& band, double sampleRate)
+{
+    // the makers keep the frequency clear of Nyquist themselves
+    switch (band.type)
+    {
+        case USER_BAND_PEAK:        return makePeakCoefficients(sampleRate, band.frequency, band.quality, band.gainInDecibels);
+        case USER_BAND_LOW_SHELF:   return makeLowShelfCoefficients(sampleRate, band.frequency, band.quality, band.gainInDecibels);
+        case USER_BAND_HIGH_SHELF:  return makeHighShelfCoefficients(sampleRate, band.frequency, band.quality, band.gainInDecibels);
+        case USER_BAND_NOTCH:       return makeNotchCoefficients(sampleRate, band.frequency, band.quality);
+        case USER_BAND_LOW_CUT:     return makeHighPassCoefficients(sampleRate, band.frequency, band.quality);
+        case USER_BAND_HIGH_CUT:    return makeLowPassCoefficients(sampleRate, band.frequency, band.quality);
+        case USER_BAND_OFF:
+        default:                    return {};
+    }
+}
+
+//==============================================================================
+using Complex = std::complex<double>;
+
+static Complex getSectionResponse(const BiquadCoefficients& section, Complex w) noexcept
+{
+    return ((double) section.b0 + w * ((double) section.b1 + w * (double) section.b2))
+         / (1.0 + w * ((double) section.a1 + w * (double) section.a2));
+}
+
+static Complex getResponse(const ParallelSections& sections, Complex w) noexcept
+{
+    auto response = sections.isParallel ? Complex((double) sections.directGain) : Complex(1.0);
+
+    for (int k = 0; k < sections.numSections; ++k)
+    {
+        if (sections.isParallel)
+            response += getSectionResponse(sections.sections[(size_t) k], w);
+        else
+            response *= getSectionResponse(sections.sections[(size_t) k], w);
+    }
+
+    return response;
+}
+
+/*  Partial fraction expansion of the cascade, in w = z^-1:
+
+        H(w) = prod B_j(w) / prod (1 - p_i w) = c + sum r_i / (1 - p_i w)
+
+    c is the ratio of the leading coefficients, prod b2 / prod a2, and each
+    residue is r_i = N(1 / p_i) / prod_{k != i} (1 - p_k / p_i). A section's
+    two poles are conjugates or both real, so recombining their residues
+    over the section's own denominator gives real b0 and b1 and no b2.
+
+    Returns false if the poles coincide, or the expansion isn't finite.
+*/
+static bool expandToParallel(ParallelSections& parallel, const std::array<BiquadCoefficients, (size_t) maxUserBands>& cascade,
+                             const std::array<bool, (size_t) maxUserBands>& active, int numSections)
+{
+    std::array<Complex, (size_t) maxUserBands * 2> poles;
+    std::array<int, (size_t) maxUserBands * 2> poleSection;
+    int numPoles = 0;
+    auto directGain = 1.0;
+
+    for (int k = 0; k < numSections; ++k)
+    {
+        if (!active[(size_t) k])
+            continue;
+
+        const auto& section = cascade[(size_t) k];
+
+        // a second order denominator is what the expansion counts on
+        if (section.a2 == 0.0f)
+            return false;
+
+        const auto root = std::sqrt(Complex((double) section.a1 * section.a1 - 4.0 * section.a2));
+
+        poles[(size_t) numPoles] = (-(double) section.a1 + root) * 0.5;
+        poleSection[(size_t) numPoles++] = k;
+        poles[(size_t) numPoles] = (-(double) section.a1 - root) * 0.5;
+        poleSection[(size_t) numPoles++] = k;
+
+        directGain *= (double) section.b2 / (double) section.a2;
+    }
+
+    std::array<Complex, (size_t) maxUserBands * 2> residues;
+
+    for (int i = 0; i < numPoles; ++i)
+    {
+        const auto w = 1.0 / poles[(size_t) i];
+        Complex numerator(1.0), denominator(1.0);
+
+        for (int k = 0; k < numSections; ++k)
+            if (active[(size_t) k])
+                numerator *= (double) cascade[(size_t) k].b0 + w * ((double) cascade[(size_t) k].b1 + w * (double) cascade[(size_t) k].b2);
+
+        for (int k = 0; k < numPoles; ++k)
+            if (k != i)
+                denominator *= 1.0 - poles[(size_t) k] * w;
+
+        // only exactly coinciding poles are caught here, near misses show up as huge residues that fail the check afterwards
+        if (denominator == Complex(0.0))
+            return false;
+
+        residues[(size_t) i] = numerator / denominator;
+    }
+
+    parallel.sections.fill({ 0.0f, 0.0f, 0.0f, 0.0f, 0.0f });
+    parallel.numSections = numSections;
+    parallel.directGain = (float) directGain;
+    parallel.isParallel = true;
+
+    for (int i = 0; i < numPoles; i += 2)
+    {
+        const auto p = poles[(size_t) i], q = poles[(size_t) i + 1];
+        const auto rp = residues[(size_t) i], rq = residues[(size_t) i + 1];
+        auto& section = parallel.sections[(size_t) poleSection[(size_t) i]];
+
+        section.b0 = (float) (rp + rq).real();
+        section.b1 = (float) -(rp * q + rq * p).real();
+        section.a1 = cascade[(size_t) poleSection[(size_t) i]].a1;
+        section.a2 = cascade[(size_t) poleSection[(size_t) i]].a2;
+    }
+
+    return std::isfinite(parallel.directGain)
+        && std::all_of(parallel.sections.begin(), parallel.sections.end(),
+                       [](const BiquadCoefficients& section) { return std::isfinite(section.b0) && std::isfinite(section.b1); });
+}
+
+void designParallelSections(ParallelSections& sections, const UserBandArray& bands, int numBands, double sampleRate, bool allowParallel)
+{
+    static constexpr int numCheckPoints = 48;
+    static constexpr double tolerance = 1.0e-3;
+
+    std::array<BiquadCoefficients, (size_t) maxUserBands> designs, cascade;
+    std::array<bool, (size_t) maxUserBands> active{};
+    auto numActive = 0, numSwitchedOn = 0;
+
+    numBands = juce::jlimit(0, maxUserBands, numBands);
+
+    for (int k = 0; k < numBands; ++k)
+    {
+        active[(size_t) k] = !bands[(size_t) k].isIdentity();
+
+        if (bands[(size_t) k].type != USER_BAND_OFF)
+        {
+            designs[(size_t) k] = makeUserBandCoefficients(bands[(size_t) k], sampleRate);
+            numSwitchedOn = k + 1;
+        }
+
+        cascade[(size_t) k] = active[(size_t) k] ? designs[(size_t) k] : BiquadCoefficients();
+
+        if (active[(size_t) k])
+            numActive = k + 1;
+    }
+
+    ParallelSections cascadeForm;
+    cascadeForm.sections = cascade;
+    cascadeForm.numSections = numActive;
+    cascadeForm.isParallel = false;
+
+    // with no active band at all this is an empty parallel bank, so the first gain moved away from 0 dB doesn't switch form
+    if (!allowParallel || !expandToParallel(sections, cascade, active, numActive))
+    {
+        sections = cascadeForm;
+        return;
+    }
+
+    // the expansion is exact in double, but the residues can be large and cancel each other,
+    // so check what's left after rounding to float against the cascade itself
+    for (int point = 0; point < numCheckPoints; ++point)
+    {
+        const auto frequency = 20.0 * std::pow(juce::jmin(20000.0, sampleRate * 0.49) / 20.0, point / (double) (numCheckPoints - 1));
+        const auto w = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate);
+        const auto expected = getResponse(cascadeForm, w);
+
+        if (std::abs(getResponse(sections, w) - expected) > tolerance * juce::jmax(std::abs(expected), 0.01))
+        {
+            sections = cascadeForm;
+            return;
+        }
+    }
+
+    // 0 dB bands contribute nothing, but their poles keep running so a gain leaving 0 dB doesn't start from cold
+    for (int k = 0; k < numSwitchedOn; ++k)
+    {
+        if (!active[(size_t) k])
+        {
+            sections.sections[(size_t) k].a1 = designs[(size_t) k].a1;
+            sections.sections[(size_t) k].a2 = designs[(size_t) k].a2;
+        }
+    }
+
+    sections.numSections = numSwitchedOn;
+}
+
+double getMagnitudeForFrequency(const ParallelSections& sections, double frequency, double sampleRate) noexcept
+{
+    return std::abs(getResponse(sections, std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate)));
+}
+
+double getDecayTimeSeconds(const ParallelSections& sections, double sampleRate, double thresholdDecibels) noexcept
+{
+    // side by side only the slowest section matters, one after another their decay times add up
+    if (sections.isParallel)
+        return getDecayTimeSeconds(sections.sections.data(), sections.numSections, sampleRate, thresholdDecibels);
+
+    auto seconds = 0.0;
+
+    for (int k = 0; k < sections.numSections; ++k)
+        seconds += getDecayTimeSeconds(&sections.sections[(size_t) k], 1, sampleRate, thresholdDecibels);
+
+    return seconds;
+}
+
+//==============================================================================
+UserBandDesigner::UserBandDesigner(juce::AudioProcessorValueTreeState& parameterManager, int numBands)
+    : parameterManager(parameterManager), numBands(juce::jlimit(0, maxUserBands, numBands))
+{
+    for (int band = 0; band < this->numBands; ++band)
+    {
+        auto& parameters = bandParameters[(size_t) band];
+        parameters.type = parameterManager.getRawParameterValue(getBandParameterID(band, "Type"));
+        parameters.frequency = parameterManager.getRawParameterValue(getBandParameterID(band, "Freq"));
+        parameters.gain = parameterManager.getRawParameterValue(getBandParameterID(band, "Gain"));
+        parameters.quality = parameterManager.getRawParameterValue(getBandParameterID(band, "Q"));
+
+        for (auto* name : { "Type", "Freq", "Gain", "Q" })
+            parameterManager.addParameterListener(getBandParameterID(band, name), this);
+    }
+
+    designerThread->add(this);
+}
+
+UserBandDesigner::~UserBandDesigner()
+{
+    designerThread->remove(this);
+
+    for (int band = 0; band < numBands; ++band)
+        for (auto* name : { "Type", "Freq", "Gain", "Q" })
+            parameterManager.removeParameterListener(getBandParameterID(band, name), this);
+}
+
+UserBandArray UserBandDesigner::getCurrentSettings() const noexcept
+{
+    UserBandArray bands;
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        auto& parameters = bandParameters[(size_t) band];
+        auto& settings = bands[(size_t) band];
+
+        settings.type = static_cast<UserBandType>(juce::jlimit(0, (int) USER_BAND_HIGH_CUT, (int) parameters.type->load()));
+        settings.frequency = parameters.frequency->load();
+        settings.gainInDecibels = parameters.gain->load();
+        settings.quality = parameters.quality->load();
+    }
+
+    return bands;
+}
+
+void UserBandDesigner::prepare(double newSampleRate)
+{
+    const juce::ScopedLock sl(designLock);
+
+    sampleRate = newSampleRate;
+    designedBands = getCurrentSettings();
+    designParallelSections(designedSections, designedBands, numBands, sampleRate);
+    publish();
+}
+
+void UserBandDesigner::designPendingChanges()
+{
+    const juce::ScopedLock sl(designLock);
+
+    if (!needsDesign.exchange(false) || sampleRate <= 0)
+        return;
+
+    const auto bands = getCurrentSettings();
+
+    // every section depends on every band in parallel form, so there's no redesigning just the band that moved
+    if (std::equal(bands.begin(), bands.end(), designedBands.begin()))
+        return;
+
+    // the form is kept while only values move, see the class description
+    const auto allowParallel = designedSections.isParallel || !haveSameTypes(bands, designedBands);
+
+    designedBands = bands;
+    designParallelSections(designedSections, designedBands, numBands, sampleRate, allowParallel);
+    publish();
+}
+
+void UserBandDesigner::parameterChanged(const juce::String&, float)
+{
+    needsDesign.store(true);
+}
+
+void UserBandDesigner::publish()
+{
+    sectionSets.getWriteBuffer() = designedSections;
+    sectionSets.publish();
+}
@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    UserBands.h
+    The optional bank of freely assignable bands, compiled in when
+    EQ_NUM_USER_BANDS is 8 to 24. Each band is one second-order section, and
+    the whole bank is turned into a parallel sum of sections so they can run
+    side by side in SIMD lanes instead of one after another.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientDesigner.h"
+
+// 0 leaves the plain three band EQ, otherwise the number of extra bands, 8 to 24
+#ifndef EQ_NUM_USER_BANDS
+ #define EQ_NUM_USER_BANDS 0
+#endif
+
+static_assert(EQ_NUM_USER_BANDS == 0 || (EQ_NUM_USER_BANDS >= 8 && EQ_NUM_USER_BANDS <= 24), "EQ_NUM_USER_BANDS has to be 0 or 8 to 24");
+
+constexpr int maxUserBands = 24;
+
+// Same order as the "Band N Type" choices
+enum UserBandType
+{
+    USER_BAND_OFF,
+    USER_BAND_PEAK,
+    USER_BAND_LOW_SHELF,
+    USER_BAND_HIGH_SHELF,
+    USER_BAND_NOTCH,
+    USER_BAND_LOW_CUT,
+    USER_BAND_HIGH_CUT
+};
+
+struct UserBandSettings
+{
+    UserBandType type{ USER_BAND_OFF };
+    float frequency{ 1000.0f }, gainInDecibels{ 0 }, quality{ 1.0f };
+
+    // Off, or a peak or shelf with no gain: the band doesn't change the signal
+    bool isIdentity() const noexcept;
+};
+
+using UserBandArray = std::array<UserBandSettings, (size_t) maxUserBands>;
+
+/**
+    Coefficients for the whole bank. In parallel form section k is band k's
+    share of the partial fraction expansion, b2 is always 0, and the output
+    is directGain * x plus the sum of every section's output. Off bands get
+    all-zero sections. A band that doesn't change the signal (0 dB) keeps its
+    poles with a zero numerator, so its state is already running when its
+    gain moves.
+
+    When the expansion can't be trusted (coinciding poles, or float rounding
+    throwing the response off) isParallel is false and the sections are the
+    bands' own biquads, to be run as a plain cascade.
+*/
+struct ParallelSections
+{
+    std::array<BiquadCoefficients, (size_t) maxUserBands> sections;
+    int numSections{ 0 };
+    float directGain{ 1.0f };
+    bool isParallel{ true };
+};
+
+// "Band N Type", "Band N Freq", "Band N Gain" and "Band N Q" for bands 1 to numBands
+void addUserBandParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout, int numBands);
+
+BiquadCoefficients makeUserBandCoefficients(const UserBandSettings& band, double sampleRate);
+
+// Designs every band and expands the cascade into parallel form, falling back to the cascade if that fails.
+// With allowParallel false it goes straight to the cascade.
+void designParallelSections(ParallelSections& sections, const UserBandArray& bands, int numBands, double sampleRate,
+                            bool allowParallel = true);
+
+// Linear magnitude response of the bank at a frequency in Hz, either form
+double getMagnitudeForFrequency(const ParallelSections& sections, double frequency, double sampleRate) noexcept;
+
+// Seconds for the bank's impulse response to fall below thresholdDecibels
+double getDecayTimeSeconds(const ParallelSections& sections, double sampleRate, double thresholdDecibels = -120.0) noexcept;
+
+
+//==============================================================================
+/**
+    The user bands' counterpart of CoefficientDesigner: parameter listeners
+    flag a change, the shared designer thread designs the bank and publishes
+    it, and the audio thread pulls the newest one at block start.
+
+    The form only changes with the band types. While just frequencies, gains
+    and Qs move the bank stays in the form it has, except that a parallel bank
+    the expansion can no longer be trusted for drops to the cascade until the
+    types change again. So automating a band switches form at most once.
+*/
+class UserBandDesigner : public DesignerThread::Client,
+                         private juce::AudioProcessorValueTreeState::Listener
+{
+public:
+    UserBandDesigner(juce::AudioProcessorValueTreeState& parameterManager, int numBands);
+    ~UserBandDesigner() override;
+
+    // Not realtime safe: designs the bank for the new sample rate and publishes it straight away
+    void prepare(double sampleRate);
+
+    void designPendingChanges() override;
+
+    // Audio thread only
+    bool pullLatest() noexcept { return sectionSets.pull(); }
+    const ParallelSections& getLatest() const noexcept { return sectionSets.getReadBuffer(); }
+
+    UserBandArray getCurrentSettings() const noexcept;
+
+private:
+    struct BandParameters
+    {
+        std::atomic<float>* type{ nullptr };
+        std::atomic<float>* frequency{ nullptr };
+        std::atomic<float>* gain{ nullptr };
+        std::atomic<float>* quality{ nullptr };
+    };
+
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void publish();
+
+    juce::AudioProcessorValueTreeState& parameterManager;
+    const int numBands;
+    std::array<BandParameters, (size_t) maxUserBands> bandParameters;
+
+    juce::CriticalSection designLock;
+    UserBandArray designedBands;
+    ParallelSections designedSections;
+    double sampleRate{ 0 };
+
+    std::atomic<bool> needsDesign{ false };
+    TripleBuffer<ParallelSections> sectionSets;
+
+    juce::SharedResourcePointer<DesignerThread> designerThread;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(UserBandDesigner)
+};
@@ -0,0 +1,365 @@
+/*
+  ==============================================================================
+
+    BatchRenderer.cpp
+    Headless command line renderer. Streams audio files through the EQ
+    processor, spreading the files across a pool of worker threads.
+
+    Usage:
+        EQBatchRenderer --output <dir> [options] <input files...>
+
+        --output <dir>          where the rendered files are written, under their paths relative to
+                                the inputs' common folder
+        --state <file>          saved plugin state (binary or XML) to load before rendering
+        --set "<id>=<value>"    sets a parameter in its real units, can be repeated
+        --block-size <n>        samples per processBlock call (default 4096)
+        --threads <n>           worker threads (default: one per core)
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "PluginProcessor.h"
+
+namespace
+{
+struct RenderSettings
+{
+    juce::File outputDirectory, stateFile;
+    juce::StringPairArray parameterValues;
+    int blockSize{ 4096 };
+    int numThreads{ juce::SystemStats::getNumCpus() };
+};
+
+struct RenderResult
+{
+    juce::File input;
+    double audioSeconds{ 0 }, processSeconds{ 0 };
+    juce::String error;
+};
+
+//==============================================================================
+bool applySettings(_3BandEQTutorialAudioProcessor& processor, const RenderSettings& settings, juce::String& error)
+{
+    if (settings.stateFile != juce::File())
+    {
+        // the same readers setStateInformation uses, called directly so a bad file is reported
+        juce::MemoryBlock state;
+
+        if (!settings.stateFile.loadFileAsData(state)
+            || !(readBinaryState(processor.parameterManager, state.getData(), (int) state.getSize())
+                 || readXmlState(processor.parameterManager, state.getData(), (int) state.getSize())))
+        {
+            error = "couldn't read state from " + settings.stateFile.getFullPathName();
+            return false;
+        }
+    }
+
+    for (auto& parameterID : settings.parameterValues.getAllKeys())
+    {
+        auto* parameter = processor.parameterManager.getParameter(parameterID);
+
+        if (parameter == nullptr)
+        {
+            error = "unknown parameter \"" + parameterID + "\"";
+            return false;
+        }
+
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(settings.parameterValues[parameterID].getFloatValue()));
+    }
+
+    return true;
+}
+
+std::unique_ptr<juce::AudioFormatReader> createReader(juce::AudioFormatManager& formats, const juce::File& file)
+{
+    // WAV and AIFF can be memory mapped, which saves streaming the file through an extra copy
+    if (auto* format = formats.findFormatForFileExtension(file.getFileExtension()))
+    {
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader(format->createMemoryMappedReader(file));
+
+        if (mappedReader != nullptr && mappedReader->mapEntireFile())
+            return mappedReader;
+    }
+
+    return std::unique_ptr<juce::AudioFormatReader>(formats.createReaderFor(file));
+}
+
+std::unique_ptr<juce::AudioFormatWriter> createWriter(juce::AudioFormatManager& formats, const juce::File& file,
+                                                      const juce::AudioFormatReader& reader)
+{
+    auto* format = formats.findFormatForFileExtension(file.getFileExtension());
+
+    if (format == nullptr)
+        return {};
+
+    file.deleteFile();
+    auto stream = file.createOutputStream();
+
+    if (stream == nullptr || stream->failedToOpen())
+        return {};
+
+    auto bitsPerSample = format->getPossibleBitDepths().contains((int) reader.bitsPerSample) ? (int) reader.bitsPerSample : 24;
+    std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), reader.sampleRate, reader.numChannels,
+                                                                            bitsPerSample, {}, 0));
+
+    if (writer != nullptr)
+        stream.release(); // the writer owns it now
+
+    return writer;
+}
+
+RenderResult renderFile(const juce::File& input, const juce::File& output, const RenderSettings& settings)
+{
+    RenderResult result;
+    result.input = input;
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    auto reader = createReader(formats, input);
+
+    if (reader == nullptr)
+    {
+        result.error = "couldn't open input";
+        return result;
+    }
+
+    if (!output.getParentDirectory().createDirectory())
+    {
+        result.error = "couldn't create " + output.getParentDirectory().getFullPathName();
+        return result;
+    }
+
+    auto writer = createWriter(formats, output, *reader);
+
+    if (writer == nullptr)
+    {
+        result.error = "couldn't create " + output.getFullPathName();
+        return result;
+    }
+
+    _3BandEQTutorialAudioProcessor processor;
+
+    // match the main bus to the file, whatever its channel count
+    auto numChannels = (int) reader->numChannels;
+    auto channelSet = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+
+    if (channelSet.isDisabled())
+        channelSet = juce::AudioChannelSet::discreteChannels(numChannels);
+
+    auto layout = processor.getBusesLayout();
+    layout.inputBuses.getReference(0) = channelSet;
+    layout.outputBuses.getReference(0) = channelSet;
+
+    if (!processor.setBusesLayout(layout))
+    {
+        result.error = "unsupported channel count " + juce::String(numChannels);
+        return result;
+    }
+
+    if (!applySettings(processor, settings, result.error))
+        return result;
+
+    processor.setNonRealtime(true);
+    processor.setRateAndBufferSizeDetails(reader->sampleRate, settings.blockSize);
+    processor.prepareToPlay(reader->sampleRate, settings.blockSize);
+
+    // run past the end by the processor's latency and drop that many samples from the start,
+    // so the output lines up with the input
+    const auto latency = (juce::int64) processor.getLatencySamples();
+    const auto length = reader->lengthInSamples;
+
+    juce::AudioBuffer<float> buffer(numChannels, settings.blockSize);
+    juce::MidiBuffer midi;
+    juce::int64 processTicks = 0;
+
+    for (juce::int64 position = 0; position < length + latency; position += settings.blockSize)
+    {
+        const auto numSamples = (int) juce::jmin((juce::int64) settings.blockSize, length + latency - position);
+        buffer.setSize(numChannels, numSamples, false, false, true);
+        buffer.clear();
+
+        if (position < length)
+            reader->read(&buffer, 0, (int) juce::jmin((juce::int64) numSamples, length - position), position, true, true);
+
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        processor.processBlock(buffer, midi);
+        processTicks += juce::Time::getHighResolutionTicks() - startTicks;
+
+        const auto skip = (int) juce::jlimit((juce::int64) 0, (juce::int64) numSamples, latency - position);
+
+        if (!writer->writeFromAudioSampleBuffer(buffer, skip, numSamples - skip))
+        {
+            result.error = "write failed";
+            return result;
+        }
+    }
+
+    processor.releaseResources();
+
+    result.audioSeconds = (double) length / reader->sampleRate;
+    result.processSeconds = juce::Time::highResolutionTicksToSeconds(processTicks);
+    return result;
+}
+
+//==============================================================================
+// One job per file. Idle workers take the next queued file from the pool, so long
+// and short stems balance out across the cores on their own.
+class RenderJob : public juce::ThreadPoolJob
+{
+public:
+    RenderJob(const juce::File& inputToUse, const juce::File& outputToUse, const RenderSettings& settingsToUse)
+        : juce::ThreadPoolJob("Render " + inputToUse.getFileName()), input(inputToUse), output(outputToUse), settings(settingsToUse)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        result = renderFile(input, output, settings);
+        return jobHasFinished;
+    }
+
+    RenderResult result;
+
+private:
+    juce::File input, output;
+    const RenderSettings& settings;
+};
+
+// Stems from different folders often share file names, so each output keeps its input's path relative to
+// the folder all the inputs have in common. Two jobs must never write the same file, and none may overwrite
+// a file that is still to be read, so both are refused before anything is rendered.
+bool getOutputFiles(const juce::Array<juce::File>& inputs, const juce::File& outputDirectory, juce::Array<juce::File>& outputs)
+{
+    auto commonRoot = inputs.getFirst().getParentDirectory();
+
+    for (auto& input : inputs)
+        while (!input.isAChildOf(commonRoot) && commonRoot != commonRoot.getParentDirectory())
+            commonRoot = commonRoot.getParentDirectory();
+
+    juce::Array<juce::File> resolvedInputs;
+
+    for (auto& input : inputs)
+        resolvedInputs.add(input.getLinkedTarget());
+
+    for (auto& input : inputs)
+    {
+        const auto output = outputDirectory.getChildFile(input.getRelativePathFrom(commonRoot));
+
+        if (outputs.contains(output))
+        {
+            std::cerr << input.getFullPathName() << ": renders to the same file as another input, " << output.getFullPathName() << std::endl;
+            return false;
+        }
+
+        if (resolvedInputs.contains(output.getLinkedTarget()))
+        {
+            std::cerr << input.getFullPathName() << ": output " << output.getFullPathName() << " would overwrite an input" << std::endl;
+            return false;
+        }
+
+        outputs.add(output);
+    }
+
+    return true;
+}
+
+void printUsage()
+{
+    std::cout << "Usage: EQBatchRenderer --output <dir> [--state <file>] [--set \"<id>=<value>\"]..." << std::endl
+              << "                       [--block-size <n>] [--threads <n>] <input files...>" << std::endl;
+}
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    RenderSettings settings;
+    juce::Array<juce::File> inputs;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        juce::String argument(argv[i]);
+        auto hasValue = i + 1 < argc;
+
+        if (argument == "--output" && hasValue)
+            settings.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+        else if (argument == "--state" && hasValue)
+            settings.stateFile = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+        else if (argument == "--set" && hasValue)
+        {
+            juce::String assignment(argv[++i]);
+            settings.parameterValues.set(assignment.upToFirstOccurrenceOf("=", false, false).trim(),
+                                         assignment.fromFirstOccurrenceOf("=", false, false).trim());
+        }
+        else if (argument == "--block-size" && hasValue)
+            settings.blockSize = juce::jmax(1, juce::String(argv[++i]).getIntValue());
+        else if (argument == "--threads" && hasValue)
+            settings.numThreads = juce::jmax(1, juce::String(argv[++i]).getIntValue());
+        else if (argument.startsWith("--"))
+        {
+            printUsage();
+            return 1;
+        }
+        else
+            inputs.add(juce::File::getCurrentWorkingDirectory().getChildFile(argument));
+    }
+
+    if (inputs.isEmpty() || settings.outputDirectory == juce::File() || !settings.outputDirectory.createDirectory())
+    {
+        printUsage();
+        return 1;
+    }
+
+    juce::Array<juce::File> outputs;
+
+    if (!getOutputFiles(inputs, settings.outputDirectory, outputs))
+        return 1;
+
+    juce::ThreadPool pool(settings.numThreads);
+    juce::OwnedArray<RenderJob> jobs;
+
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    for (int i = 0; i < inputs.size(); ++i)
+        pool.addJob(jobs.add(new RenderJob(inputs[i], outputs[i], settings)), false);
+
+    for (auto* job : jobs)
+        pool.waitForJobToFinish(job, -1);
+
+    const auto wallSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+    double totalAudioSeconds = 0, totalProcessSeconds = 0;
+    int numFailed = 0;
+
+    for (auto* job : jobs)
+    {
+        auto& result = job->result;
+
+        if (result.error.isNotEmpty())
+        {
+            std::cerr << result.input.getFullPathName() << ": " << result.error << std::endl;
+            ++numFailed;
+            continue;
+        }
+
+        totalAudioSeconds += result.audioSeconds;
+        totalProcessSeconds += result.processSeconds;
+
+        std::cout << result.input.getFileName() << ": " << juce::String(result.audioSeconds, 2) << " s of audio, "
+                  << juce::String(result.audioSeconds / juce::jmax(result.processSeconds, 1.0e-9), 1) << "x realtime" << std::endl;
+    }
+
+    // processing-only speed is what one core manages inside processBlock, the wall clock figure includes file IO
+    std::cout << std::endl
+              << "Rendered " << (jobs.size() - numFailed) << " of " << jobs.size() << " files on " << settings.numThreads << " threads" << std::endl
+              << "  processBlock: " << juce::String(totalAudioSeconds / juce::jmax(totalProcessSeconds, 1.0e-9), 1) << "x realtime per core" << std::endl
+              << "  wall clock:   " << juce::String(totalAudioSeconds / juce::jmax(wallSeconds, 1.0e-9), 1) << "x realtime, "
+              << juce::String(totalAudioSeconds / juce::jmax(wallSeconds * settings.numThreads, 1.0e-9), 1) << "x realtime per core" << std::endl;
+
+    return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,663 @@
+/*
+  ==============================================================================
+
+    Benchmark.cpp
+    Drives prepareToPlay/processBlock directly and sweeps block size, sample
+    rate, slope, channel layout and automation density. Results are written
+    one line per configuration, so two builds can be diffed or compared.
+
+    Usage:
+        EQBenchmark [options]
+
+        --output <file>             .csv or .json results (default: print a table only)
+        --compare <file>            .csv from an earlier run, exits with 1 on a regression
+        --tolerance <percent>       allowed slowdown before --compare fails (default 10)
+        --block-sizes <n,n,...>     default 16,32,...,8192
+        --sample-rates <n,n,...>    default 44100,48000,96000,192000,384000
+        --slopes <n,n,...>          cut slopes in dB/Oct, default 12,24,36,48
+        --layouts <name,...>        mono, stereo, 5.1, 7.1.4, ambisonic3 (default: all)
+        --automation <name,...>     none, sparse, dense (default: all)
+        --control-rates <n,...>     "Control Rate" choice index, default 0 (off)
+        --seconds <s>               audio measured per configuration (default 0.5)
+        --dynamic                   run every configuration with the peak band in dynamic mode, compare against
+                                    a static baseline with --tolerance 50 to check it stays within 1.5x
+        --restore <n>               instead of the sweep, time constructing <n> instances and restoring
+                                    their state, binary against XML, like a project being opened
+        --cache <n>                 instead of the sweep, prepare <n> instances with the same settings and
+                                    report the shared coefficient cache's hit rate
+        --abort-on-violation        with EQ_REALTIME_SAFETY_CHECKS, abort on the first allocation, lock or
+                                    blocking call inside processBlock instead of reporting them at the end
+
+    Built with EQ_REALTIME_SAFETY_CHECKS, every configuration is also checked for allocations, locks and
+    blocking calls inside processBlock, and any violation makes the run exit with 1.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include <map>
+#include "PluginProcessor.h"
+#include "CoefficientCache.h"
+#include "RealtimeSafety.h"
+#include "../Common/AllocationCounter.h"
+
+namespace
+{
+// how often the benchmark moves the parameters while measuring
+enum Automation
+{
+    AUTOMATION_NONE,    // parameters never move
+    AUTOMATION_SPARSE,  // a change every 50 ms, roughly what a drawn automation lane produces
+    AUTOMATION_DENSE    // every band changes before every block
+};
+
+const char* const automationNames[] = { "none", "sparse", "dense" };
+
+struct Layout
+{
+    const char* name;
+    juce::AudioChannelSet channelSet;
+};
+
+const Layout layouts[] = { { "mono", juce::AudioChannelSet::mono() },
+                           { "stereo", juce::AudioChannelSet::stereo() },
+                           { "5.1", juce::AudioChannelSet::create5point1() },
+                           { "7.1.4", juce::AudioChannelSet::create7point1point4() },
+                           { "ambisonic3", juce::AudioChannelSet::ambisonic(3) } };
+
+struct SweepSettings
+{
+    juce::Array<int> blockSizes{ 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192 };
+    juce::Array<double> sampleRates{ 44100.0, 48000.0, 96000.0, 192000.0, 384000.0 };
+    juce::Array<int> slopes{ 12, 24, 36, 48 };
+    juce::Array<int> layoutIndices{ 0, 1, 2, 3, 4 };
+    juce::Array<int> automations{ AUTOMATION_NONE, AUTOMATION_SPARSE, AUTOMATION_DENSE };
+    juce::Array<int> controlRates{ 0 };
+    double seconds{ 0.5 };
+    bool dynamic{ false };
+};
+
+struct Configuration
+{
+    int blockSize{ 0 };
+    double sampleRate{ 0 };
+    int slope{ 0 }, layoutIndex{ 0 }, automation{ 0 }, controlRate{ 0 };
+
+    // identifies the configuration across runs
+    juce::String getKey() const
+    {
+        return juce::String(juce::roundToInt(sampleRate)) + "/" + juce::String(blockSize) + "/" + layouts[layoutIndex].name + "/"
+             + juce::String(slope) + "/" + automationNames[automation] + "/" + juce::String(controlRate);
+    }
+};
+
+struct Result
+{
+    Configuration configuration;
+    int numChannels{ 0 }, numBlocks{ 0 };
+    double nsPerSample{ 0 }, nsPerChannelSample{ 0 };
+    double p50Ns{ 0 }, p99Ns{ 0 }, maxNs{ 0 };
+    double budgetPercent{ 0 }; // p99 block time against the realtime deadline for one block
+    double allocationsPerBlock{ 0 };
+};
+
+//==============================================================================
+void setParameter(_3BandEQTutorialAudioProcessor& processor, const juce::String& parameterID, float value)
+{
+    auto* parameter = processor.parameterManager.getParameter(parameterID);
+    jassert(parameter != nullptr);
+
+    parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+// sweeps every band so each change forces a redesign of the whole chain
+void moveParameters(_3BandEQTutorialAudioProcessor& processor, int changeIndex)
+{
+    const auto phase = (float) changeIndex * 0.37f;
+
+    setParameter(processor, "LowCut Freq", 40.0f + 60.0f * (1.0f + std::sin(phase)));
+    setParameter(processor, "Peak Freq", 1000.0f * std::pow(4.0f, std::sin(phase * 1.3f)));
+    setParameter(processor, "Peak Gain", 12.0f * std::sin(phase * 0.7f));
+    setParameter(processor, "HiCut Freq", 12000.0f + 4000.0f * std::sin(phase * 1.1f));
+}
+
+double getPercentile(const std::vector<double>& sortedValues, double percentile)
+{
+    const auto index = (size_t) juce::jlimit(0.0, (double) sortedValues.size() - 1.0, std::ceil(percentile * (double) sortedValues.size()) - 1.0);
+    return sortedValues[index];
+}
+
+Result runConfiguration(const Configuration& configuration, double seconds, bool dynamic)
+{
+    Result result;
+    result.configuration = configuration;
+
+    _3BandEQTutorialAudioProcessor processor;
+
+    auto layout = processor.getBusesLayout();
+    layout.inputBuses.getReference(0) = layouts[configuration.layoutIndex].channelSet;
+    layout.outputBuses.getReference(0) = layouts[configuration.layoutIndex].channelSet;
+
+    if (!processor.setBusesLayout(layout))
+        return result;
+
+    const auto slopeIndex = (float) juce::jlimit(0, 3, configuration.slope / 12 - 1);
+    setParameter(processor, "LowCut Slope", slopeIndex);
+    setParameter(processor, "HiCut Slope", slopeIndex);
+    setParameter(processor, "HiCut Freq", 16000.0f);
+    setParameter(processor, "Peak Gain", 6.0f);
+    setParameter(processor, "Control Rate", (float) configuration.controlRate);
+
+    // the noise sits well above the default threshold, so the band is compressing the whole time
+    if (dynamic)
+        setParameter(processor, "Dynamic Mode", 1.0f);
+
+    processor.setRateAndBufferSizeDetails(configuration.sampleRate, configuration.blockSize);
+    processor.prepareToPlay(configuration.sampleRate, configuration.blockSize);
+
+    const auto numChannels = processor.getTotalNumInputChannels();
+    const auto blockSize = configuration.blockSize;
+
+    // the same block of noise goes in every time, so the filters never settle into denormals or silence
+    juce::AudioBuffer<float> source(numChannels, blockSize), buffer(numChannels, blockSize);
+    juce::Random random(0x3b);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int i = 0; i < blockSize; ++i)
+            source.setSample(channel, i, random.nextFloat() * 0.5f - 0.25f);
+
+    juce::MidiBuffer midi;
+
+    const auto numWarmUpBlocks = 16;
+    const auto numBlocks = juce::jmax(200, (int) std::ceil(seconds * configuration.sampleRate / blockSize));
+    const auto blocksPerChange = juce::jmax(1, (int) std::round(0.05 * configuration.sampleRate / blockSize));
+
+    std::vector<double> blockNs;
+    blockNs.reserve((size_t) numBlocks);
+
+    const auto nsPerTick = 1.0e9 / (double) juce::Time::getHighResolutionTicksPerSecond();
+    juce::int64 totalTicks = 0, totalAllocations = 0;
+
+    for (int block = 0; block < numWarmUpBlocks + numBlocks; ++block)
+    {
+        if (configuration.automation == AUTOMATION_DENSE
+            || (configuration.automation == AUTOMATION_SPARSE && block % blocksPerChange == 0))
+            moveParameters(processor, block);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            buffer.copyFrom(channel, 0, source, channel, 0, blockSize);
+
+        AllocationCounter::start();
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        processor.processBlock(buffer, midi);
+
+        const auto ticks = juce::Time::getHighResolutionTicks() - startTicks;
+        const auto numAllocations = AllocationCounter::stop();
+
+        if (block < numWarmUpBlocks)
+            continue;
+
+        blockNs.push_back((double) ticks * nsPerTick);
+        totalTicks += ticks;
+        totalAllocations += numAllocations;
+    }
+
+    processor.releaseResources();
+
+    std::sort(blockNs.begin(), blockNs.end());
+
+    const auto totalNs = (double) totalTicks * nsPerTick;
+    const auto totalSamples = (double) numBlocks * blockSize;
+    const auto budgetNs = 1.0e9 * blockSize / configuration.sampleRate;
+
+    result.numChannels = numChannels;
+    result.numBlocks = numBlocks;
+    result.nsPerSample = totalNs / totalSamples;
+    result.nsPerChannelSample = totalNs / (totalSamples * numChannels);
+    result.p50Ns = getPercentile(blockNs, 0.5);
+    result.p99Ns = getPercentile(blockNs, 0.99);
+    result.maxNs = blockNs.back();
+    result.budgetPercent = 100.0 * result.p99Ns / budgetNs;
+    result.allocationsPerBlock = (double) totalAllocations / numBlocks;
+    return result;
+}
+
+//==============================================================================
+const char* const csvHeader = "sample_rate,block_size,layout,channels,slope,automation,control_rate,blocks,"
+                              "ns_per_sample,ns_per_channel_sample,p50_ns,p99_ns,max_ns,budget_percent,allocations_per_block";
+
+juce::String toCSVLine(const Result& result)
+{
+    auto& configuration = result.configuration;
+
+    return juce::StringArray{ juce::String(juce::roundToInt(configuration.sampleRate)), juce::String(configuration.blockSize),
+                              juce::String(layouts[configuration.layoutIndex].name), juce::String(result.numChannels),
+                              juce::String(configuration.slope), juce::String(automationNames[configuration.automation]),
+                              juce::String(configuration.controlRate), juce::String(result.numBlocks),
+                              juce::String(result.nsPerSample, 3), juce::String(result.nsPerChannelSample, 3),
+                              juce::String(juce::roundToInt(result.p50Ns)), juce::String(juce::roundToInt(result.p99Ns)), juce::String(juce::roundToInt(result.maxNs)),
+                              juce::String(result.budgetPercent, 3), juce::String(result.allocationsPerBlock, 3) }
+        .joinIntoString(",");
+}
+
+juce::var toJSON(const Result& result)
+{
+    auto& configuration = result.configuration;
+    auto* object = new juce::DynamicObject();
+
+    object->setProperty("sample_rate", configuration.sampleRate);
+    object->setProperty("block_size", configuration.blockSize);
+    object->setProperty("layout", layouts[configuration.layoutIndex].name);
+    object->setProperty("channels", result.numChannels);
+    object->setProperty("slope", configuration.slope);
+    object->setProperty("automation", automationNames[configuration.automation]);
+    object->setProperty("control_rate", configuration.controlRate);
+    object->setProperty("blocks", result.numBlocks);
+    object->setProperty("ns_per_sample", result.nsPerSample);
+    object->setProperty("ns_per_channel_sample", result.nsPerChannelSample);
+    object->setProperty("p50_ns", result.p50Ns);
+    object->setProperty("p99_ns", result.p99Ns);
+    object->setProperty("max_ns", result.maxNs);
+    object->setProperty("budget_percent", result.budgetPercent);
+    object->setProperty("allocations_per_block", result.allocationsPerBlock);
+    return juce::var(object);
+}
+
+bool writeResults(const juce::File& file, const juce::Array<Result>& results)
+{
+    juce::String text;
+
+    if (file.hasFileExtension("json"))
+    {
+        juce::Array<juce::var> entries;
+
+        for (auto& result : results)
+            entries.add(toJSON(result));
+
+        auto* root = new juce::DynamicObject();
+        root->setProperty("cpu", juce::SystemStats::getCpuModel());
+        root->setProperty("simd_lanes", SIMDFilterEngine::numLanes);
+        root->setProperty("results", entries);
+        text = juce::JSON::toString(juce::var(root));
+    }
+    else
+    {
+        text << csvHeader << "\n";
+
+        for (auto& result : results)
+            text << toCSVLine(result) << "\n";
+    }
+
+    return file.replaceWithText(text);
+}
+
+//==============================================================================
+// Compares against a CSV baseline. Timing is only checked on the mean and p99, max is too noisy to gate on,
+// but any new allocation on the audio thread counts as a regression.
+int compareWithBaseline(const juce::File& baselineFile, const juce::Array<Result>& results, double tolerancePercent)
+{
+    juce::StringArray lines;
+    baselineFile.readLines(lines);
+    lines.removeEmptyStrings();
+
+    if (lines.isEmpty() || lines[0] != csvHeader)
+    {
+        std::cerr << "baseline " << baselineFile.getFullPathName() << " isn't a CSV file from this benchmark" << std::endl;
+        return -1;
+    }
+
+    std::map<juce::String, juce::StringArray> baseline;
+
+    for (int i = 1; i < lines.size(); ++i)
+    {
+        auto fields = juce::StringArray::fromTokens(lines[i], ",", {});
+        auto key = fields[0] + "/" + fields[1] + "/" + fields[2] + "/" + fields[4] + "/" + fields[5] + "/" + fields[6];
+        baseline[key] = fields;
+    }
+
+    const auto limit = 1.0 + tolerancePercent / 100.0;
+    int numRegressions = 0;
+
+    for (auto& result : results)
+    {
+        auto found = baseline.find(result.configuration.getKey());
+
+        if (found == baseline.end())
+            continue;
+
+        auto& fields = found->second;
+        const auto oldNsPerSample = fields[8].getDoubleValue();
+        const auto oldP99 = fields[11].getDoubleValue();
+        const auto oldAllocations = fields[14].getDoubleValue();
+
+        juce::StringArray problems;
+
+        if (result.nsPerSample > oldNsPerSample * limit)
+            problems.add("ns/sample " + juce::String(oldNsPerSample, 3) + " -> " + juce::String(result.nsPerSample, 3));
+
+        if (result.p99Ns > oldP99 * limit)
+            problems.add("p99 " + juce::String(juce::roundToInt(oldP99)) + " -> " + juce::String(juce::roundToInt(result.p99Ns)) + " ns");
+
+        if (result.allocationsPerBlock > oldAllocations)
+            problems.add("allocations/block " + juce::String(oldAllocations, 3) + " -> " + juce::String(result.allocationsPerBlock, 3));
+
+        if (problems.isEmpty())
+            continue;
+
+        std::cout << "REGRESSION " << result.configuration.getKey() << ": " << problems.joinIntoString(", ") << std::endl;
+        ++numRegressions;
+    }
+
+    return numRegressions;
+}
+
+//==============================================================================
+// every band away from its default, so nothing restores or prepares for free
+void setSessionParameters(_3BandEQTutorialAudioProcessor& processor)
+{
+    moveParameters(processor, 3);
+    setParameter(processor, "Quality", 2.5f);
+    setParameter(processor, "LowCut Slope", 2.0f);
+    setParameter(processor, "HiCut Slope", 1.0f);
+}
+
+struct RestoreTiming
+{
+    double constructMs{ 0 }, restoreMs{ 0 };
+    bool restoredCorrectly{ true };
+};
+
+// the instances are only destroyed after the timing, closing a project isn't what's measured
+RestoreTiming timeRestore(int numInstances, const juce::MemoryBlock& state, const juce::MemoryBlock& expectedState)
+{
+    juce::OwnedArray<_3BandEQTutorialAudioProcessor> instances;
+    instances.ensureStorageAllocated(numInstances);
+
+    const auto msPerTick = 1.0e3 / (double) juce::Time::getHighResolutionTicksPerSecond();
+    RestoreTiming timing;
+
+    for (int i = 0; i < numInstances; ++i)
+    {
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        auto* instance = instances.add(new _3BandEQTutorialAudioProcessor());
+        const auto constructedTicks = juce::Time::getHighResolutionTicks();
+        instance->setStateInformation(state.getData(), (int) state.getSize());
+        const auto restoredTicks = juce::Time::getHighResolutionTicks();
+
+        timing.constructMs += (double) (constructedTicks - startTicks) * msPerTick;
+        timing.restoreMs += (double) (restoredTicks - constructedTicks) * msPerTick;
+    }
+
+    for (auto* instance : instances)
+    {
+        juce::MemoryBlock restoredState;
+        instance->getStateInformation(restoredState);
+        timing.restoredCorrectly = timing.restoredCorrectly && restoredState == expectedState;
+    }
+
+    return timing;
+}
+
+int runRestoreBenchmark(int numInstances)
+{
+    _3BandEQTutorialAudioProcessor source;
+    setSessionParameters(source);
+
+    juce::MemoryBlock binaryState, xmlState;
+    source.getStateInformation(binaryState);
+
+    if (auto xml = source.parameterManager.copyState().createXml())
+        juce::AudioProcessor::copyXmlToBinary(*xml, xmlState);
+
+    std::cout << numInstances << " instances" << std::endl
+              << juce::String("format").paddedRight(' ', 8) << juce::String("bytes").paddedLeft(' ', 7)
+              << juce::String("construct ms").paddedLeft(' ', 14) << juce::String("restore ms").paddedLeft(' ', 12)
+              << juce::String("total ms").paddedLeft(' ', 10) << juce::String("restore us/inst").paddedLeft(' ', 17) << std::endl;
+
+    auto failed = false;
+
+    for (auto* format : { "binary", "xml" })
+    {
+        auto& state = juce::String(format) == "binary" ? binaryState : xmlState;
+        auto timing = timeRestore(numInstances, state, binaryState);
+
+        std::cout << juce::String(format).paddedRight(' ', 8) << juce::String((int) state.getSize()).paddedLeft(' ', 7)
+                  << juce::String(timing.constructMs, 1).paddedLeft(' ', 14) << juce::String(timing.restoreMs, 1).paddedLeft(' ', 12)
+                  << juce::String(timing.constructMs + timing.restoreMs, 1).paddedLeft(' ', 10)
+                  << juce::String(1000.0 * timing.restoreMs / juce::jmax(1, numInstances), 2).paddedLeft(' ', 17) << std::endl;
+
+        if (!timing.restoredCorrectly)
+        {
+            std::cerr << format << ": restored parameters don't match the saved ones" << std::endl;
+            failed = true;
+        }
+    }
+
+    return failed ? 1 : 0;
+}
+
+//==============================================================================
+// a session full of identical EQs: only the first instance should have to design anything
+int runCacheBenchmark(int numInstances)
+{
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+
+    juce::OwnedArray<_3BandEQTutorialAudioProcessor> instances;
+
+    for (int i = 0; i < numInstances; ++i)
+        setSessionParameters(*instances.add(new _3BandEQTutorialAudioProcessor()));
+
+    auto& cache = CoefficientCache::getInstance();
+    cache.clear();
+
+    const auto msPerTick = 1.0e3 / (double) juce::Time::getHighResolutionTicksPerSecond();
+    double firstMs = 0, restMs = 0;
+
+    for (int i = 0; i < numInstances; ++i)
+    {
+        auto* instance = instances[i];
+        instance->setRateAndBufferSizeDetails(sampleRate, blockSize);
+
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        instance->prepareToPlay(sampleRate, blockSize);
+        const auto elapsedMs = (double) (juce::Time::getHighResolutionTicks() - startTicks) * msPerTick;
+
+        (i == 0 ? firstMs : restMs) += elapsedMs;
+    }
+
+    const auto statistics = cache.getStatistics();
+
+    std::cout << numInstances << " instances, prepareToPlay ms: first " << juce::String(firstMs, 3)
+              << ", others " << juce::String(restMs / juce::jmax(1, numInstances - 1), 3) << " each" << std::endl
+              << "coefficient cache: " << statistics.hits << " hits, " << statistics.misses << " misses ("
+              << juce::String(100.0 * statistics.getHitRate(), 1) << "%), " << statistics.insertions << " insertions, "
+              << statistics.evictions << " evictions, " << statistics.numEntries << "/" << statistics.capacity << " entries" << std::endl;
+
+    return 0;
+}
+
+template <typename Type>
+juce::Array<Type> parseList(const juce::String& text)
+{
+    juce::Array<Type> values;
+
+    for (auto& token : juce::StringArray::fromTokens(text, ",", {}))
+        values.add((Type) token.trim().getDoubleValue());
+
+    return values;
+}
+
+juce::Array<int> parseNames(const juce::String& text, const juce::StringArray& names)
+{
+    juce::Array<int> indices;
+
+    for (auto& token : juce::StringArray::fromTokens(text, ",", {}))
+        if (names.contains(token.trim()))
+            indices.add(names.indexOf(token.trim()));
+
+    return indices;
+}
+
+void printUsage()
+{
+    std::cout << "Usage: EQBenchmark [--output <file.csv|file.json>] [--compare <baseline.csv>] [--tolerance <percent>]" << std::endl
+              << "                   [--block-sizes <n,...>] [--sample-rates <n,...>] [--slopes <n,...>]" << std::endl
+              << "                   [--layouts <mono,stereo,5.1,7.1.4,ambisonic3>] [--automation <none,sparse,dense>]" << std::endl
+              << "                   [--control-rates <n,...>] [--seconds <s>] [--dynamic] [--abort-on-violation]" << std::endl
+              << "       EQBenchmark --restore <instances>" << std::endl
+              << "       EQBenchmark --cache <instances>" << std::endl;
+}
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    SweepSettings sweep;
+    juce::File outputFile, baselineFile;
+    double tolerancePercent = 10.0;
+    int numRestoreInstances = 0, numCacheInstances = 0;
+
+    juce::StringArray layoutNames;
+
+    for (auto& layout : layouts)
+        layoutNames.add(layout.name);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        juce::String argument(argv[i]);
+        auto hasValue = i + 1 < argc;
+
+        if (argument == "--output" && hasValue)
+            outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+        else if (argument == "--compare" && hasValue)
+            baselineFile = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+        else if (argument == "--tolerance" && hasValue)
+            tolerancePercent = juce::String(argv[++i]).getDoubleValue();
+        else if (argument == "--block-sizes" && hasValue)
+            sweep.blockSizes = parseList<int>(argv[++i]);
+        else if (argument == "--sample-rates" && hasValue)
+            sweep.sampleRates = parseList<double>(argv[++i]);
+        else if (argument == "--slopes" && hasValue)
+            sweep.slopes = parseList<int>(argv[++i]);
+        else if (argument == "--layouts" && hasValue)
+            sweep.layoutIndices = parseNames(argv[++i], layoutNames);
+        else if (argument == "--automation" && hasValue)
+            sweep.automations = parseNames(argv[++i], juce::StringArray(automationNames, (int) std::size(automationNames)));
+        else if (argument == "--control-rates" && hasValue)
+            sweep.controlRates = parseList<int>(argv[++i]);
+        else if (argument == "--seconds" && hasValue)
+            sweep.seconds = juce::jmax(0.0, juce::String(argv[++i]).getDoubleValue());
+        else if (argument == "--dynamic")
+            sweep.dynamic = true;
+        else if (argument == "--restore" && hasValue)
+            numRestoreInstances = juce::jmax(1, juce::String(argv[++i]).getIntValue());
+        else if (argument == "--cache" && hasValue)
+            numCacheInstances = juce::jmax(1, juce::String(argv[++i]).getIntValue());
+       #if EQ_REALTIME_SAFETY_CHECKS
+        else if (argument == "--abort-on-violation")
+            RealtimeSafety::setAbortOnViolation(true);
+       #endif
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (numRestoreInstances > 0)
+        return runRestoreBenchmark(numRestoreInstances);
+
+    if (numCacheInstances > 0)
+        return runCacheBenchmark(numCacheInstances);
+
+    if (!AllocationCounter::isCountingMalloc())
+        std::cout << "note: only operator new is counted on this platform, plain malloc calls are not" << std::endl;
+
+    juce::Array<Result> results;
+
+    std::cout << juce::String("rate").paddedLeft(' ', 7) << juce::String("block").paddedLeft(' ', 6)
+              << juce::String("layout").paddedLeft(' ', 11) << juce::String("slope").paddedLeft(' ', 6)
+              << juce::String("auto").paddedLeft(' ', 7) << juce::String("ctrl").paddedLeft(' ', 5)
+              << juce::String("ns/smp").paddedLeft(' ', 10) << juce::String("p50 us").paddedLeft(' ', 10)
+              << juce::String("p99 us").paddedLeft(' ', 10) << juce::String("max us").paddedLeft(' ', 10)
+              << juce::String("budget%").paddedLeft(' ', 9) << juce::String("allocs").paddedLeft(' ', 8) << std::endl;
+
+    for (auto sampleRate : sweep.sampleRates)
+        for (auto blockSize : sweep.blockSizes)
+            for (auto layoutIndex : sweep.layoutIndices)
+                for (auto slope : sweep.slopes)
+                    for (auto automation : sweep.automations)
+                        for (auto controlRate : sweep.controlRates)
+                        {
+                            if (blockSize <= 0 || sampleRate <= 0)
+                                continue;
+
+                            Configuration configuration{ blockSize, sampleRate, slope, layoutIndex, automation, controlRate };
+
+                           #if EQ_REALTIME_SAFETY_CHECKS
+                            const auto violationsBefore = RealtimeSafety::getNumViolations();
+                           #endif
+
+                            auto result = runConfiguration(configuration, sweep.seconds, sweep.dynamic);
+
+                           #if EQ_REALTIME_SAFETY_CHECKS
+                            if (const auto numViolations = RealtimeSafety::getNumViolations() - violationsBefore)
+                                std::cerr << configuration.getKey() << ": " << numViolations << " realtime safety violation(s) in processBlock" << std::endl;
+                           #endif
+
+                            if (result.numBlocks == 0)
+                            {
+                                std::cerr << configuration.getKey() << ": layout not supported" << std::endl;
+                                continue;
+                            }
+
+                            results.add(result);
+
+                            std::cout << juce::String(juce::roundToInt(sampleRate)).paddedLeft(' ', 7) << juce::String(blockSize).paddedLeft(' ', 6)
+                                      << juce::String(layouts[layoutIndex].name).paddedLeft(' ', 11) << juce::String(slope).paddedLeft(' ', 6)
+                                      << juce::String(automationNames[automation]).paddedLeft(' ', 7) << juce::String(controlRate).paddedLeft(' ', 5)
+                                      << juce::String(result.nsPerSample, 2).paddedLeft(' ', 10)
+                                      << juce::String(result.p50Ns / 1000.0, 2).paddedLeft(' ', 10)
+                                      << juce::String(result.p99Ns / 1000.0, 2).paddedLeft(' ', 10)
+                                      << juce::String(result.maxNs / 1000.0, 2).paddedLeft(' ', 10)
+                                      << juce::String(result.budgetPercent, 2).paddedLeft(' ', 9)
+                                      << juce::String(result.allocationsPerBlock, 2).paddedLeft(' ', 8) << std::endl;
+                        }
+
+    if (outputFile != juce::File() && !writeResults(outputFile, results))
+    {
+        std::cerr << "couldn't write " << outputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+   #if EQ_REALTIME_SAFETY_CHECKS
+    // a build that allocates or locks on the audio thread fails however fast it is
+    if (const auto numViolations = RealtimeSafety::getNumViolations())
+    {
+        std::cout << numViolations << " realtime safety violation(s) in processBlock, the first ones are printed above with their stack" << std::endl;
+        return 1;
+    }
+   #endif
+
+    if (baselineFile != juce::File())
+    {
+        auto numRegressions = compareWithBaseline(baselineFile, results, tolerancePercent);
+
+        if (numRegressions != 0)
+        {
+            if (numRegressions > 0)
+                std::cout << numRegressions << " configuration(s) regressed by more than " << tolerancePercent << "%" << std::endl;
+
+            return 1;
+        }
+
+        std::cout << "No regressions against " << baselineFile.getFileName() << std::endl;
+    }
+
+    return 0;
+}
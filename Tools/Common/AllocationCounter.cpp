@@ -0,0 +1,148 @@
+/*
+  ==============================================================================
+
+    AllocationCounter.cpp
+
+    With glibc the malloc family itself is replaced, which also catches
+    JUCE's HeapBlock and anything else that bypasses operator new. Elsewhere
+    only the global operator new/delete replacements are available.
+
+    With EQ_REALTIME_SAFETY_CHECKS every allocation made inside a
+    RealtimeSafety::ScopedRealtimeContext is also reported as a violation.
+
+  ==============================================================================
+*/
+
+#include "AllocationCounter.h"
+#include "RealtimeSafety.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    // constant initialised, so touching them never allocates
+    thread_local bool isCounting = false;
+    thread_local int64_t numAllocations = 0;
+
+    // function is only used for the realtime safety report
+    inline void countAllocation(const char* function) noexcept
+    {
+        if (isCounting)
+            ++numAllocations;
+
+       #if EQ_REALTIME_SAFETY_CHECKS
+        if (RealtimeSafety::isInRealtimeContext())
+            RealtimeSafety::reportViolation(RealtimeSafety::VIOLATION_ALLOCATION, function);
+       #else
+        (void) function;
+       #endif
+    }
+}
+
+void AllocationCounter::start() noexcept
+{
+    numAllocations = 0;
+    isCounting = true;
+}
+
+int64_t AllocationCounter::stop() noexcept
+{
+    isCounting = false;
+    return numAllocations;
+}
+
+#if defined(__GLIBC__)
+
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+
+    void* malloc(size_t size)
+    {
+        countAllocation("malloc");
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t numElements, size_t elementSize)
+    {
+        countAllocation("calloc");
+        return __libc_calloc(numElements, elementSize);
+    }
+
+    void* realloc(void* pointer, size_t size)
+    {
+        countAllocation("realloc");
+        return __libc_realloc(pointer, size);
+    }
+
+    void* memalign(size_t alignment, size_t size)
+    {
+        countAllocation("memalign");
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** result, size_t alignment, size_t size)
+    {
+        countAllocation("posix_memalign");
+
+        // the same checks as glibc's own, and *result is left alone on failure
+        if (alignment == 0 || (alignment & (alignment - 1)) != 0 || alignment % sizeof(void*) != 0)
+            return EINVAL;
+
+        auto* pointer = __libc_memalign(alignment, size);
+
+        if (pointer == nullptr)
+            return ENOMEM;
+
+        *result = pointer;
+        return 0;
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size)
+    {
+        countAllocation("aligned_alloc");
+        return __libc_memalign(alignment, size);
+    }
+}
+
+bool AllocationCounter::isCountingMalloc() noexcept { return true; }
+
+#else
+
+void* operator new(std::size_t size)
+{
+    countAllocation("operator new");
+
+    if (auto* pointer = std::malloc(size == 0 ? 1 : size))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+   #if EQ_REALTIME_SAFETY_CHECKS
+    if (pointer != nullptr && RealtimeSafety::isInRealtimeContext())
+        RealtimeSafety::reportViolation(RealtimeSafety::VIOLATION_DEALLOCATION, "operator delete");
+   #endif
+
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept { operator delete(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { operator delete(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { operator delete(pointer); }
+
+bool AllocationCounter::isCountingMalloc() noexcept { return false; }
+
+#endif
@@ -0,0 +1,25 @@
+/*
+  ==============================================================================
+
+    AllocationCounter.h
+    Counts heap allocations made by the calling thread, so the tools can
+    check how often processBlock hits the allocator.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace AllocationCounter
+{
+    // Starts counting allocations made on this thread
+    void start() noexcept;
+
+    // Stops counting and returns the number of allocations since start()
+    int64_t stop() noexcept;
+
+    // False where only operator new can be intercepted, so plain malloc calls go unseen
+    bool isCountingMalloc() noexcept;
+}
@@ -0,0 +1,260 @@
+/*
+  ==============================================================================
+
+    RealtimeSafetyHooks.cpp
+
+    Replaces free, the pthread locks and the usual blocking system calls for
+    the whole executable and reports any call made while the thread is in
+    a RealtimeSafety::ScopedRealtimeContext, before forwarding it to libc.
+    Allocations are reported by AllocationCounter.cpp, which already
+    replaces the malloc family, so the two are linked together.
+
+    glibc only, elsewhere this compiles to nothing and only operator new
+    and delete are checked.
+
+  ==============================================================================
+*/
+
+// the fortified inline wrappers for open and friends would clash with the replacements
+#undef _FORTIFY_SOURCE
+
+#include "RealtimeSafety.h"
+
+#if EQ_REALTIME_SAFETY_CHECKS && defined(__GLIBC__)
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/select.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace
+{
+    inline void check(RealtimeSafety::ViolationType type, const char* function) noexcept
+    {
+        if (RealtimeSafety::isInRealtimeContext())
+            RealtimeSafety::reportViolation(type, function);
+    }
+
+    // Looks up the libc function the replacement hides, once. A plain atomic rather than a function
+    // static, because a static's init guard may itself take a lock and land back in pthread_mutex_lock.
+    template <typename Function>
+    Function getNext(std::atomic<void*>& next, const char* name) noexcept
+    {
+        auto* function = next.load(std::memory_order_acquire);
+
+        if (function == nullptr)
+        {
+            function = dlsym(RTLD_NEXT, name);
+            next.store(function, std::memory_order_release);
+        }
+
+        return reinterpret_cast<Function>(function);
+    }
+
+    // open's mode argument is only there with O_CREAT or O_TMPFILE
+    inline bool hasMode(int flags) noexcept
+    {
+        return (flags & O_CREAT) != 0 || (flags & O_TMPFILE) == O_TMPFILE;
+    }
+}
+
+#define EQ_CALL_NEXT(name, ...)                                     \
+    static std::atomic<void*> next##name{ nullptr };                \
+    return getNext<decltype(&name)>(next##name, #name)(__VA_ARGS__)
+
+extern "C"
+{
+    void __libc_free(void*);
+
+    void free(void* pointer) noexcept
+    {
+        if (pointer != nullptr)
+            check(RealtimeSafety::VIOLATION_DEALLOCATION, "free");
+
+        __libc_free(pointer);
+    }
+
+    //==============================================================================
+    int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+    {
+        check(RealtimeSafety::VIOLATION_LOCK, "pthread_mutex_lock");
+        EQ_CALL_NEXT(pthread_mutex_lock, mutex);
+    }
+
+    int pthread_rwlock_rdlock(pthread_rwlock_t* lock) noexcept
+    {
+        check(RealtimeSafety::VIOLATION_LOCK, "pthread_rwlock_rdlock");
+        EQ_CALL_NEXT(pthread_rwlock_rdlock, lock);
+    }
+
+    int pthread_rwlock_wrlock(pthread_rwlock_t* lock) noexcept
+    {
+        check(RealtimeSafety::VIOLATION_LOCK, "pthread_rwlock_wrlock");
+        EQ_CALL_NEXT(pthread_rwlock_wrlock, lock);
+    }
+
+    int pthread_cond_wait(pthread_cond_t* condition, pthread_mutex_t* mutex)
+    {
+        check(RealtimeSafety::VIOLATION_LOCK, "pthread_cond_wait");
+        EQ_CALL_NEXT(pthread_cond_wait, condition, mutex);
+    }
+
+    int pthread_cond_timedwait(pthread_cond_t* condition, pthread_mutex_t* mutex, const struct timespec* time)
+    {
+        check(RealtimeSafety::VIOLATION_LOCK, "pthread_cond_timedwait");
+        EQ_CALL_NEXT(pthread_cond_timedwait, condition, mutex, time);
+    }
+
+    int sem_wait(sem_t* semaphore)
+    {
+        check(RealtimeSafety::VIOLATION_LOCK, "sem_wait");
+        EQ_CALL_NEXT(sem_wait, semaphore);
+    }
+
+    int sem_timedwait(sem_t* semaphore, const struct timespec* time)
+    {
+        check(RealtimeSafety::VIOLATION_LOCK, "sem_timedwait");
+        EQ_CALL_NEXT(sem_timedwait, semaphore, time);
+    }
+
+    //==============================================================================
+    int nanosleep(const struct timespec* duration, struct timespec* remaining)
+    {
+        check(RealtimeSafety::VIOLATION_BLOCKING_CALL, "nanosleep");
+        EQ_CALL_NEXT(nanosleep, duration, remaining);
+    }
+
+    int clock_nanosleep(clockid_t clock, int flags, const struct timespec* duration, struct timespec* remaining)
+    {
+        check(RealtimeSafety::VIOLATION_BLOCKING_CALL, "clock_nanosleep");
+        EQ_CALL_NEXT(clock_nanosleep, clock, flags, duration, remaining);
+    }
+
+    int usleep(useconds_t microseconds)
+    {
+        check(RealtimeSafety::VIOLATION_BLOCKING_CALL, "usleep");
+        EQ_CALL_NEXT(usleep, microseconds);
+    }
+
+    unsigned int sleep(unsigned int seconds)
+    {
+        check(RealtimeSafety::VIOLATION_BLOCKING_CALL, "sleep");
+        EQ_CALL_NEXT(sleep, seconds);
+    }
+
+    ssize_t read(int fd, void* buffer, size_t size)
+    {
+        check(RealtimeSafety::VIOLATION_BLOCKING_CALL, "read");
+        EQ_CALL_NEXT(read, fd, buffer, size);
+    }
+
+    ssize_t write(int fd, const void* buffer, size_t size)
+    {
+        check(RealtimeSafety::VIOLATION_BLOCKING_CALL, "write");
+        EQ_CALL_NEXT(write, fd, buffer, size);
+    }
+
+    int poll(struct pollfd* fds, nfds_t numFds, int timeout)
+    {
+        check(RealtimeSafety::VIOLATION_BLOCKING_CALL, "poll");
+        EQ_CALL_NEXT(poll, fds, numFds, timeout);
+    }
+
+    int select(int numFds, fd_set* readFds, fd_set* writeFds, fd_set* exceptFds, struct timeval* timeout)
+    {
+        check(RealtimeSafety::VIOLATION_BLOCKING_CALL, "select");
+        EQ_CALL_NEXT(select, numFds, readFds, writeFds, exceptFds, timeout);
+    }
+
+    FILE* fopen(const char* path, const char* mode)
+    {
+        check(RealtimeSafety::VIOLATION_BLOCKING_CALL, "fopen");
+        EQ_CALL_NEXT(fopen, path, mode);
+    }
+
+    // the large file variants are separate symbols, and the ones a _FILE_OFFSET_BITS=64 build calls instead
+    FILE* fopen64(const char* path, const char* mode)
+    {
+        check(RealtimeSafety::VIOLATION_BLOCKING_CALL, "fopen64");
+        EQ_CALL_NEXT(fopen64, path, mode);
+    }
+
+    int open(const char* path, int flags, ...)
+    {
+        check(RealtimeSafety::VIOLATION_BLOCKING_CALL, "open");
+
+        mode_t mode = 0;
+
+        if (hasMode(flags))
+        {
+            va_list arguments;
+            va_start(arguments, flags);
+            mode = (mode_t) va_arg(arguments, unsigned int);
+            va_end(arguments);
+        }
+
+        EQ_CALL_NEXT(open, path, flags, mode);
+    }
+
+    int openat(int directoryFd, const char* path, int flags, ...)
+    {
+        check(RealtimeSafety::VIOLATION_BLOCKING_CALL, "openat");
+
+        mode_t mode = 0;
+
+        if (hasMode(flags))
+        {
+            va_list arguments;
+            va_start(arguments, flags);
+            mode = (mode_t) va_arg(arguments, unsigned int);
+            va_end(arguments);
+        }
+
+        EQ_CALL_NEXT(openat, directoryFd, path, flags, mode);
+    }
+
+    int open64(const char* path, int flags, ...)
+    {
+        check(RealtimeSafety::VIOLATION_BLOCKING_CALL, "open64");
+
+        mode_t mode = 0;
+
+        if (hasMode(flags))
+        {
+            va_list arguments;
+            va_start(arguments, flags);
+            mode = (mode_t) va_arg(arguments, unsigned int);
+            va_end(arguments);
+        }
+
+        EQ_CALL_NEXT(open64, path, flags, mode);
+    }
+
+    int openat64(int directoryFd, const char* path, int flags, ...)
+    {
+        check(RealtimeSafety::VIOLATION_BLOCKING_CALL, "openat64");
+
+        mode_t mode = 0;
+
+        if (hasMode(flags))
+        {
+            va_list arguments;
+            va_start(arguments, flags);
+            mode = (mode_t) va_arg(arguments, unsigned int);
+            va_end(arguments);
+        }
+
+        EQ_CALL_NEXT(openat64, directoryFd, path, flags, mode);
+    }
+}
+
+#undef EQ_CALL_NEXT
+
+#endif
@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+
+    TelemetryMonitor.cpp
+    Prints the counters every running EQ instance publishes through its
+    telemetry segment. Only maps the files, so it never touches the audio
+    threads it is watching.
+
+    Usage:
+        EQTelemetryMonitor [--watch <seconds>] [--reset]
+
+        --watch <seconds>   keep refreshing at this interval
+        --reset             ask every instance to clear its counters, then exit
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "PerformanceTelemetry.h"
+
+#if EQ_ENABLE_TELEMETRY
+
+namespace
+{
+struct Segment
+{
+    juce::File file;
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+
+    TelemetryData* getData() const noexcept { return static_cast<TelemetryData*>(mappedFile->getData()); }
+};
+
+juce::OwnedArray<Segment> openSegments(juce::MemoryMappedFile::AccessMode accessMode)
+{
+    juce::OwnedArray<Segment> segments;
+
+    for (auto& file : getTelemetryDirectory().findChildFiles(juce::File::findFiles, false, "*.telemetry"))
+    {
+        auto segment = std::make_unique<Segment>();
+        segment->file = file;
+        segment->mappedFile = std::make_unique<juce::MemoryMappedFile>(file, accessMode);
+
+        // files from a crashed host or an older build are skipped rather than misread
+        if (segment->mappedFile->getData() == nullptr || segment->mappedFile->getSize() < sizeof(TelemetryData))
+            continue;
+
+        auto* data = segment->getData();
+
+        if (data->magic != TelemetryData::magicNumber || data->version != TelemetryData::currentVersion)
+            continue;
+
+        segments.add(segment.release());
+    }
+
+    return segments;
+}
+
+void printSegments(const juce::OwnedArray<Segment>& segments)
+{
+    std::cout << juce::String("instance").paddedRight(' ', 16) << juce::String("rate").paddedLeft(' ', 8)
+              << juce::String("ch").paddedLeft(' ', 4) << juce::String("blocks").paddedLeft(' ', 11)
+              << juce::String("ns/smp").paddedLeft(' ', 9) << juce::String("budget%").paddedLeft(' ', 9)
+              << juce::String("max us").paddedLeft(' ', 9) << juce::String("overruns").paddedLeft(' ', 10)
+              << juce::String("redesigns").paddedLeft(' ', 11) << juce::String("decaying").paddedLeft(' ', 10)
+              << juce::String("silent").paddedLeft(' ', 9) << juce::String("skipped").paddedLeft(' ', 9) << std::endl;
+
+    for (auto* segment : segments)
+    {
+        auto& data = *segment->getData();
+
+        const auto numSamples = (double) data.numSamples.load(std::memory_order_relaxed);
+        const auto totalBlockNs = (double) data.totalBlockNs.load(std::memory_order_relaxed);
+        const auto totalBudgetNs = (double) data.totalBudgetNs.load(std::memory_order_relaxed);
+
+        std::cout << (juce::String(data.processID) + ":" + juce::String(data.instanceID)).paddedRight(' ', 16)
+                  << juce::String(data.sampleRate.load()).paddedLeft(' ', 8)
+                  << juce::String(data.numChannels.load()).paddedLeft(' ', 4)
+                  << juce::String((juce::int64) data.numBlocks.load()).paddedLeft(' ', 11)
+                  << juce::String(numSamples > 0 ? totalBlockNs / numSamples : 0.0, 1).paddedLeft(' ', 9)
+                  << juce::String(totalBudgetNs > 0 ? 100.0 * totalBlockNs / totalBudgetNs : 0.0, 2).paddedLeft(' ', 9)
+                  << juce::String((double) data.maxBlockNs.load() / 1000.0, 1).paddedLeft(' ', 9)
+                  << juce::String((juce::int64) data.numOverruns.load()).paddedLeft(' ', 10)
+                  << juce::String((juce::int64) data.numRedesigns.load()).paddedLeft(' ', 11)
+                  << juce::String((juce::int64) data.numDecayingBlocks.load()).paddedLeft(' ', 10)
+                  << juce::String((juce::int64) data.numSilentBlocks.load()).paddedLeft(' ', 9)
+                  << juce::String((juce::int64) data.numSkippedBlocks.load()).paddedLeft(' ', 9) << std::endl;
+    }
+
+    std::cout << segments.size() << " instance(s)" << std::endl;
+}
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    double watchSeconds = 0;
+    bool reset = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        juce::String argument(argv[i]);
+
+        if (argument == "--watch" && i + 1 < argc)
+            watchSeconds = juce::jmax(0.1, juce::String(argv[++i]).getDoubleValue());
+        else if (argument == "--reset")
+            reset = true;
+        else
+        {
+            std::cout << "Usage: EQTelemetryMonitor [--watch <seconds>] [--reset]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (reset)
+    {
+        auto segments = openSegments(juce::MemoryMappedFile::readWrite);
+
+        for (auto* segment : segments)
+            segment->getData()->resetRequested.store(1, std::memory_order_relaxed);
+
+        std::cout << "Reset requested for " << segments.size() << " instance(s)" << std::endl;
+        return 0;
+    }
+
+    for (;;)
+    {
+        // rescan every time, instances come and go with the session
+        printSegments(openSegments(juce::MemoryMappedFile::readOnly));
+
+        if (watchSeconds <= 0)
+            return 0;
+
+        juce::Thread::sleep(juce::roundToInt(watchSeconds * 1000.0));
+        std::cout << std::endl;
+    }
+}
+
+#else
+
+int main()
+{
+    std::cout << "This build has EQ_ENABLE_TELEMETRY turned off" << std::endl;
+    return 1;
+}
+
+#endif
@@ -0,0 +1,1319 @@
+/*
+  ==============================================================================
+
+    Verify.cpp
+    Renders deterministic signals through every processing path of the EQ
+    and compares the output against the original juce::dsp::IIR chain, and
+    the measured magnitude response against the analytic design.
+
+    Usage:
+        EQVerify [options]
+
+        --sample-rates <n,n,...>    default 22050,32000,44100,48000,96000,192000
+        --layouts <name,...>        mono, stereo, 5.1, 7.1.4 (default: mono,stereo,7.1.4)
+        --seconds <s>               audio rendered per check (default 1)
+        --ulps <n>                  largest difference in ULPs allowed on the direct form paths (default 2048)
+        --error-db <dB>             largest error relative to the peak output on the direct form paths (default -90)
+        --loose-error-db <dB>       the same for paths that are only equivalent, not identical (default -60)
+        --response-db <dB>          largest deviation of a measured or designed response (default 0.1)
+        --fir-response-db <dB>      the same for the linear phase FIR (default 0.5)
+        --quiet                     only print failures
+
+    Built with EQ_REALTIME_SAFETY_CHECKS, every engine mode is also rendered in realtime mode and checked for
+    allocations, locks and blocking calls inside processBlock.
+
+    Exits with 1 if any check fails.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include <thread>
+#include "PluginProcessor.h"
+#include "RealtimeSafety.h"
+
+namespace
+{
+struct Tolerances
+{
+    juce::int64 ulps{ 2048 };
+    double errorDecibels{ -90.0 }, looseErrorDecibels{ -60.0 };
+    double responseDecibels{ 0.1 }, firResponseDecibels{ 0.5 };
+};
+
+struct Layout
+{
+    const char* name;
+    juce::AudioChannelSet channelSet;
+};
+
+const Layout layouts[] = { { "mono", juce::AudioChannelSet::mono() },
+                           { "stereo", juce::AudioChannelSet::stereo() },
+                           { "5.1", juce::AudioChannelSet::create5point1() },
+                           { "7.1.4", juce::AudioChannelSet::create7point1point4() } };
+
+// ragged on purpose, so partial SIMD groups and one sample blocks get exercised
+const int blockSizes[] = { 512, 1, 37, 256, 511, 64, 3, 128 };
+const int maximumBlockSize = 512;
+
+const char* const topologyNames[] = { "direct-form", "state-variable" };
+
+struct SlopePair
+{
+    Slope lowCut, highCut;
+};
+
+const SlopePair slopePairs[] = { { SLOPE_12, SLOPE_12 }, { SLOPE_24, SLOPE_24 }, { SLOPE_36, SLOPE_36 },
+                                 { SLOPE_48, SLOPE_48 }, { SLOPE_12, SLOPE_48 } };
+
+juce::String getSlopeName(const SlopePair& slopes)
+{
+    return juce::String(12 * (slopes.lowCut + 1)) + "/" + juce::String(12 * (slopes.highCut + 1));
+}
+
+//==============================================================================
+/**
+    The chain as it was first written: one ProcessorChain per channel, with
+    coefficients from juce::dsp's own designers and bypassed cut stages.
+*/
+class ReferenceChain
+{
+public:
+    void prepare(double newSampleRate, int numChannels)
+    {
+        sampleRate = newSampleRate;
+        chains.resize((size_t) numChannels);
+
+        for (auto& chain : chains)
+        {
+            chain.prepare({ sampleRate, (juce::uint32) maximumBlockSize, 1 });
+            chain.reset();
+        }
+    }
+
+    // The EQ's designers keep every frequency just below Nyquist at the rate a band is designed for,
+    // juce::dsp's don't, so the reference clamps the settings the same way first
+    static ChainSettings clampToNyquist(ChainSettings settings, double sampleRate, int oversamplingFactor = 1)
+    {
+        settings.lowCutFreq = juce::jmin(settings.lowCutFreq, (float) (sampleRate * 0.49));
+        settings.peakFreq = juce::jmin(settings.peakFreq, (float) (sampleRate * oversamplingFactor * 0.49));
+        settings.highCutFreq = juce::jmin(settings.highCutFreq, (float) (sampleRate * oversamplingFactor * 0.49));
+        return settings;
+    }
+
+    void setSettings(const ChainSettings& requestedSettings)
+    {
+        const auto settings = clampToNyquist(requestedSettings, sampleRate);
+        auto peak = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, settings.peakFreq, settings.peakQuality,
+                                                                         juce::Decibels::decibelsToGain(settings.peakGainInDecibels));
+        auto lowCut = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(settings.lowCutFreq, sampleRate,
+                                                                                                 (settings.lowCutSlope + 1) * 2);
+        auto highCut = juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(settings.highCutFreq, sampleRate,
+                                                                                                 (settings.highCutSlope + 1) * 2);
+
+        for (auto& chain : chains)
+        {
+            *chain.get<PEAK>().coefficients = *peak;
+            updateCutFilter(chain.get<LOW_CUT>(), lowCut);
+            updateCutFilter(chain.get<HIGH_CUT>(), highCut);
+        }
+    }
+
+    void process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+    {
+        for (size_t channel = 0; channel < chains.size(); ++channel)
+        {
+            auto block = juce::dsp::AudioBlock<float>(buffer).getSingleChannelBlock(channel)
+                                                              .getSubBlock((size_t) startSample, (size_t) numSamples);
+            chains[channel].process(juce::dsp::ProcessContextReplacing<float>(block));
+        }
+    }
+
+    // Exact response of the same design in double. Like the EQ, the peak and high cut are designed
+    // for the oversampled rate and the low cut for the base rate.
+    static double getMagnitudeForFrequency(const ChainSettings& requestedSettings, double frequency, double sampleRate, int oversamplingFactor = 1)
+    {
+        using Coefficients = juce::dsp::IIR::Coefficients<double>;
+
+        const auto settings = clampToNyquist(requestedSettings, sampleRate, oversamplingFactor);
+
+        const auto oversampledRate = sampleRate * oversamplingFactor;
+        auto magnitude = Coefficients::makePeakFilter(oversampledRate, settings.peakFreq, settings.peakQuality,
+                                                      juce::Decibels::decibelsToGain((double) settings.peakGainInDecibels))
+                             ->getMagnitudeForFrequency(frequency, oversampledRate);
+
+        for (auto& stage : juce::dsp::FilterDesign<double>::designIIRHighpassHighOrderButterworthMethod(settings.lowCutFreq, sampleRate,
+                                                                                                      (settings.lowCutSlope + 1) * 2))
+            magnitude *= stage->getMagnitudeForFrequency(frequency, sampleRate);
+
+        for (auto& stage : juce::dsp::FilterDesign<double>::designIIRLowpassHighOrderButterworthMethod(settings.highCutFreq, oversampledRate,
+                                                                                                     (settings.highCutSlope + 1) * 2))
+            magnitude *= stage->getMagnitudeForFrequency(frequency, oversampledRate);
+
+        return magnitude;
+    }
+
+private:
+    using Filter = juce::dsp::IIR::Filter<float>;
+    using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+    using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+    using CutCoefficients = juce::ReferenceCountedArray<juce::dsp::IIR::Coefficients<float>>;
+
+    enum ChainPositions
+    {
+        LOW_CUT,
+        PEAK,
+        HIGH_CUT
+    };
+
+    template <int Stage>
+    static void updateCutStage(CutFilter& cut, const CutCoefficients& coefficients)
+    {
+        const auto used = Stage < coefficients.size();
+        cut.setBypassed<Stage>(!used);
+
+        if (used)
+            *cut.get<Stage>().coefficients = *coefficients[Stage];
+    }
+
+    static void updateCutFilter(CutFilter& cut, const CutCoefficients& coefficients)
+    {
+        updateCutStage<0>(cut, coefficients);
+        updateCutStage<1>(cut, coefficients);
+        updateCutStage<2>(cut, coefficients);
+        updateCutStage<3>(cut, coefficients);
+    }
+
+    std::vector<MonoChain> chains;
+    double sampleRate{ 0 };
+};
+
+//==============================================================================
+struct Report
+{
+    int numChecks{ 0 }, numFailures{ 0 };
+    bool quiet{ false };
+
+    void add(const juce::String& name, bool passed, const juce::String& detail)
+    {
+        ++numChecks;
+
+        if (!passed)
+            ++numFailures;
+
+        if (!passed || !quiet)
+            std::cout << (passed ? "ok    " : "FAIL  ") << name.paddedRight(' ', 56) << detail << std::endl;
+    }
+};
+
+struct Difference
+{
+    juce::int64 maxUlps{ 0 };
+    double errorDecibels{ -300.0 };
+};
+
+juce::int64 getUlpDistance(float first, float second) noexcept
+{
+    // maps the float bit patterns onto one monotonic integer line, -0 and +0 both land on 0
+    auto toOrdered = [](float value)
+    {
+        juce::int32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits < 0 ? (juce::int64) std::numeric_limits<juce::int32>::min() - bits : (juce::int64) bits;
+    };
+
+    return std::abs(toOrdered(first) - toOrdered(second));
+}
+
+// Only samples within 60 dB of the peak count towards the ULPs, next to zero a ULP means nothing.
+// Samples with a zero in compareMask are skipped altogether.
+Difference compare(const juce::AudioBuffer<float>& output, const juce::AudioBuffer<float>& reference, const std::vector<char>& compareMask = {})
+{
+    auto peak = 0.0f;
+
+    for (int channel = 0; channel < reference.getNumChannels(); ++channel)
+        peak = juce::jmax(peak, reference.getMagnitude(channel, 0, reference.getNumSamples()));
+
+    Difference difference;
+    auto maxError = 0.0f;
+
+    for (int channel = 0; channel < reference.getNumChannels(); ++channel)
+    {
+        auto* actual = output.getReadPointer(channel);
+        auto* expected = reference.getReadPointer(channel);
+
+        for (int i = 0; i < reference.getNumSamples(); ++i)
+        {
+            if (!compareMask.empty() && compareMask[(size_t) i] == 0)
+                continue;
+
+            maxError = juce::jmax(maxError, std::abs(actual[i] - expected[i]));
+
+            if (std::abs(expected[i]) > peak * 1.0e-3f)
+                difference.maxUlps = juce::jmax(difference.maxUlps, getUlpDistance(actual[i], expected[i]));
+        }
+    }
+
+    if (peak > 0.0f && maxError > 0.0f)
+        difference.errorDecibels = juce::Decibels::gainToDecibels((double) maxError / peak, -300.0);
+
+    return difference;
+}
+
+void checkDifference(Report& report, const juce::String& name, const Difference& difference, bool identical, const Tolerances& tolerances)
+{
+    // the state variable filters compute the same response through a different structure,
+    // so only the error in dB is held to a (looser) limit, the ULPs are just reported
+    const auto errorLimit = identical ? tolerances.errorDecibels : tolerances.looseErrorDecibels;
+    const auto passed = difference.errorDecibels <= errorLimit && (!identical || difference.maxUlps <= tolerances.ulps);
+
+    report.add(name, passed, juce::String(difference.maxUlps) + " ulp, error " + juce::String(difference.errorDecibels, 1) + " dB");
+}
+
+//==============================================================================
+enum Signal
+{
+    SIGNAL_IMPULSE,
+    SIGNAL_SWEEP,
+    SIGNAL_NOISE
+};
+
+const char* const signalNames[] = { "impulse", "sweep", "noise" };
+
+// every channel gets a different signal, so channels swapped between SIMD lanes show up
+void fillSignal(juce::AudioBuffer<float>& buffer, Signal signal, double sampleRate)
+{
+    buffer.clear();
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        auto* samples = buffer.getWritePointer(channel);
+
+        if (signal == SIGNAL_IMPULSE)
+        {
+            samples[juce::jmin(channel * 7, buffer.getNumSamples() - 1)] = 1.0f;
+        }
+        else if (signal == SIGNAL_SWEEP)
+        {
+            // exponential sine sweep from 20 Hz to just under Nyquist
+            const auto duration = buffer.getNumSamples() / sampleRate;
+            const auto rate = std::log(0.45 * sampleRate / 20.0);
+            const auto offset = channel * 0.3;
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                const auto t = i / sampleRate;
+                const auto phase = juce::MathConstants<double>::twoPi * 20.0 * duration / rate * (std::exp(t * rate / duration) - 1.0);
+                samples[i] = (float) (0.5 * std::sin(phase + offset));
+            }
+        }
+        else
+        {
+            juce::Random random(0x3b + channel);
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                samples[i] = random.nextFloat() - 0.5f;
+        }
+    }
+}
+
+void setParameter(_3BandEQTutorialAudioProcessor& processor, const juce::String& parameterID, float value)
+{
+    auto* parameter = processor.parameterManager.getParameter(parameterID);
+    jassert(parameter != nullptr);
+
+    parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+void setSlopes(_3BandEQTutorialAudioProcessor& processor, const SlopePair& slopes)
+{
+    setParameter(processor, "LowCut Slope", (float) slopes.lowCut);
+    setParameter(processor, "HiCut Slope", (float) slopes.highCut);
+}
+
+struct EngineSettings
+{
+    int topology{ 0 }, oversampling{ 0 };
+    bool linearPhase{ false };
+};
+
+// Non-realtime, so the linear phase kernels are designed in line at the start of every block. The IIR chain
+// designs its own coefficients on the control interval grid either way.
+std::unique_ptr<_3BandEQTutorialAudioProcessor> createProcessor(const juce::AudioChannelSet& channelSet, const EngineSettings& engine)
+{
+    auto processor = std::make_unique<_3BandEQTutorialAudioProcessor>();
+
+    auto layout = processor->getBusesLayout();
+    layout.inputBuses.getReference(0) = channelSet;
+    layout.outputBuses.getReference(0) = channelSet;
+
+    if (!processor->setBusesLayout(layout))
+        return {};
+
+    processor->setNonRealtime(true);
+
+    setParameter(*processor, "LowCut Freq", 80.0f);
+    setParameter(*processor, "Peak Freq", 1000.0f);
+    setParameter(*processor, "Peak Gain", 6.0f);
+    setParameter(*processor, "Quality", 1.4f);
+    setParameter(*processor, "HiCut Freq", 12000.0f);
+    setParameter(*processor, "Filter Topology", (float) engine.topology);
+    setParameter(*processor, "Oversampling", (float) engine.oversampling);
+    setParameter(*processor, "Phase Mode", engine.linearPhase ? 1.0f : 0.0f);
+    setParameter(*processor, "FIR Length", 4.0f);
+
+    return processor;
+}
+
+void prepare(_3BandEQTutorialAudioProcessor& processor, double sampleRate, int blockSize = maximumBlockSize)
+{
+    processor.releaseResources();
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+}
+
+// Runs buffer through the processor and reference through the reference chain, in the same ragged blocks.
+// beforeBlock may move the parameters, the reference then follows whatever the processor holds. Like the
+// processor it only switches on the control interval grid, to the settings of the block the grid point falls in.
+void render(_3BandEQTutorialAudioProcessor& processor, ReferenceChain& referenceChain, juce::AudioBuffer<float>& buffer,
+            juce::AudioBuffer<float>& reference, const std::function<void(int)>& beforeBlock = {})
+{
+    juce::MidiBuffer midi;
+    ChainSettings referenceSettings;
+    auto hasSettings = false;
+
+    for (int start = 0, blockIndex = 0; start < buffer.getNumSamples(); ++blockIndex)
+    {
+        const auto numSamples = juce::jmin(blockSizes[blockIndex % (int) std::size(blockSizes)], buffer.getNumSamples() - start);
+
+        if (beforeBlock)
+            beforeBlock(start);
+
+        juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, numSamples);
+        processor.processBlock(block, midi);
+
+        const auto settings = processor.getCurrentChainSettings();
+        const auto controlInterval = processor.getControlInterval();
+
+        for (int segmentStart = start; segmentStart < start + numSamples;)
+        {
+            const auto segmentEnd = juce::jmin(start + numSamples, (segmentStart / controlInterval + 1) * controlInterval);
+
+            if (!hasSettings || (segmentStart % controlInterval == 0 && getChangedBands(referenceSettings, settings) != 0))
+            {
+                referenceChain.setSettings(settings);
+                referenceSettings = settings;
+                hasSettings = true;
+            }
+
+            referenceChain.process(reference, segmentStart, segmentEnd - segmentStart);
+            segmentStart = segmentEnd;
+        }
+
+        start += numSamples;
+    }
+}
+
+//==============================================================================
+struct Session
+{
+    juce::Array<double> sampleRates{ 22050.0, 32000.0, 44100.0, 48000.0, 96000.0, 192000.0 };
+    juce::Array<int> layoutIndices{ 0, 1, 3 };
+    double seconds{ 1.0 };
+    Tolerances tolerances;
+};
+
+// static settings, every signal and slope pair
+void checkStatic(Report& report, const Session& session, double sampleRate, int layoutIndex, int topology)
+{
+    const auto numSamples = juce::roundToInt(session.seconds * sampleRate);
+
+    for (auto& slopes : slopePairs)
+    {
+        for (auto signal : { SIGNAL_IMPULSE, SIGNAL_SWEEP, SIGNAL_NOISE })
+        {
+            auto processor = createProcessor(layouts[layoutIndex].channelSet, { topology, 0, false });
+            setSlopes(*processor, slopes);
+            prepare(*processor, sampleRate);
+
+            const auto numChannels = processor->getTotalNumInputChannels();
+            juce::AudioBuffer<float> buffer(numChannels, numSamples), reference(numChannels, numSamples);
+            fillSignal(buffer, signal, sampleRate);
+            reference.makeCopyOf(buffer);
+
+            ReferenceChain referenceChain;
+            referenceChain.prepare(sampleRate, numChannels);
+            render(*processor, referenceChain, buffer, reference);
+
+            checkDifference(report, juce::String(juce::roundToInt(sampleRate)) + " " + layouts[layoutIndex].name + " " + topologyNames[topology]
+                                        + " " + signalNames[signal] + " " + getSlopeName(slopes),
+                            compare(buffer, reference), topology == 0, session.tolerances);
+        }
+    }
+}
+
+// every band ramping across its range while noise plays, a parameter change on every block
+void checkAutomation(Report& report, const Session& session, double sampleRate, int layoutIndex, int topology)
+{
+    const auto numSamples = juce::roundToInt(session.seconds * sampleRate);
+    auto processor = createProcessor(layouts[layoutIndex].channelSet, { topology, 0, false });
+    setSlopes(*processor, { SLOPE_24, SLOPE_24 });
+    prepare(*processor, sampleRate);
+
+    const auto numChannels = processor->getTotalNumInputChannels();
+    juce::AudioBuffer<float> buffer(numChannels, numSamples), reference(numChannels, numSamples);
+    fillSignal(buffer, SIGNAL_NOISE, sampleRate);
+    reference.makeCopyOf(buffer);
+
+    ReferenceChain referenceChain;
+    referenceChain.prepare(sampleRate, numChannels);
+
+    render(*processor, referenceChain, buffer, reference, [&](int position)
+    {
+        const auto ramp = (float) position / (float) numSamples;
+
+        setParameter(*processor, "LowCut Freq", 20.0f * std::pow(15.0f, ramp));
+        setParameter(*processor, "Peak Freq", 200.0f * std::pow(40.0f, ramp));
+        setParameter(*processor, "Peak Gain", -12.0f + 24.0f * ramp);
+        setParameter(*processor, "Quality", 0.5f + 3.5f * ramp);
+        setParameter(*processor, "HiCut Freq", (float) juce::jmin(18000.0, 0.45 * sampleRate) * std::pow(0.2f, ramp));
+    });
+
+    checkDifference(report, juce::String(juce::roundToInt(sampleRate)) + " " + layouts[layoutIndex].name + " " + topologyNames[topology]
+                                + " automation ramp",
+                    compare(buffer, reference), topology == 0, session.tolerances);
+}
+
+// Slopes switching every half second. Both sides keep state for stages that drop out differently,
+// so the samples until the switch has rung out aren't compared.
+void checkSlopeSwitches(Report& report, const Session& session, double sampleRate, int layoutIndex, int topology)
+{
+    const auto switchInterval = juce::roundToInt(0.5 * sampleRate), settleSamples = juce::roundToInt(0.25 * sampleRate);
+    const auto numSamples = juce::jmax(juce::roundToInt(session.seconds * sampleRate), switchInterval * 4);
+
+    auto processor = createProcessor(layouts[layoutIndex].channelSet, { topology, 0, false });
+    prepare(*processor, sampleRate);
+
+    const auto numChannels = processor->getTotalNumInputChannels();
+    juce::AudioBuffer<float> buffer(numChannels, numSamples), reference(numChannels, numSamples);
+    fillSignal(buffer, SIGNAL_NOISE, sampleRate);
+    reference.makeCopyOf(buffer);
+
+    ReferenceChain referenceChain;
+    referenceChain.prepare(sampleRate, numChannels);
+
+    std::vector<char> compareMask((size_t) numSamples, 1);
+    auto lastSwitch = -1;
+
+    render(*processor, referenceChain, buffer, reference, [&](int position)
+    {
+        const auto switchIndex = position / switchInterval;
+
+        if (switchIndex == lastSwitch)
+            return;
+
+        lastSwitch = switchIndex;
+        setSlopes(*processor, { static_cast<Slope>(switchIndex % 4), static_cast<Slope>(3 - switchIndex % 4) });
+
+        if (switchIndex > 0)
+            std::fill_n(compareMask.begin() + position, juce::jmin(settleSamples, numSamples - position), (char) 0);
+    });
+
+    checkDifference(report, juce::String(juce::roundToInt(sampleRate)) + " " + layouts[layoutIndex].name + " " + topologyNames[topology]
+                                + " slope switches",
+                    compare(buffer, reference, compareMask), topology == 0, session.tolerances);
+}
+
+// The same automation rendered offline at 4096 and at 64 samples per block, with "Control Rate" off and on. The
+// parameters only move every 4096 samples, as a host bouncing at 4096 would see them, so both renders get the same
+// values and have to come out bit identical: the block size may only change how often a value is read.
+// 4096 sample blocks sent to a processor prepared for 512, oversampled with the dynamic peak on, have to match too.
+void checkBlockSizes(Report& report, const Session& session, double sampleRate, int layoutIndex, int topology)
+{
+    constexpr int automationInterval = 4096;
+    const auto numSamples = juce::jmax(juce::roundToInt(session.seconds * sampleRate), automationInterval * 4);
+    const auto name = juce::String(juce::roundToInt(sampleRate)) + " " + layouts[layoutIndex].name + " " + topologyNames[topology];
+
+    auto renderAutomation = [&](juce::AudioBuffer<float>& buffer, const EngineSettings& engine, float controlRate, bool dynamic,
+                                int preparedBlockSize, int blockSize)
+    {
+        auto processor = createProcessor(layouts[layoutIndex].channelSet, engine);
+        setParameter(*processor, "Control Rate", controlRate);
+
+        if (dynamic)
+        {
+            setParameter(*processor, "Dynamic Mode", (float) _3BandEQTutorialAudioProcessor::DYNAMIC_INPUT);
+            setParameter(*processor, "Dynamic Threshold", -30.0f);
+        }
+
+        prepare(*processor, sampleRate, preparedBlockSize);
+
+        buffer.setSize(processor->getTotalNumInputChannels(), numSamples);
+        fillSignal(buffer, SIGNAL_NOISE, sampleRate);
+
+        juce::MidiBuffer midi;
+
+        for (int start = 0; start < numSamples; start += blockSize)
+        {
+            if (start % automationInterval == 0)
+            {
+                const auto ramp = (float) start / (float) numSamples;
+                setParameter(*processor, "Peak Freq", 200.0f * std::pow(40.0f, ramp));
+                setParameter(*processor, "Peak Gain", -12.0f + 24.0f * ramp);
+                setParameter(*processor, "HiCut Freq", 16000.0f - 12000.0f * ramp);
+            }
+
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start,
+                                           juce::jmin(blockSize, numSamples - start));
+            processor->processBlock(block, midi);
+        }
+    };
+
+    auto checkIdentical = [&](const juce::String& checkName, const juce::AudioBuffer<float>& output, const juce::AudioBuffer<float>& expected)
+    {
+        const auto difference = compare(output, expected);
+
+        report.add(name + " " + checkName, difference.maxUlps == 0 && difference.errorDecibels <= -300.0,
+                   juce::String(difference.maxUlps) + " ulp, error " + juce::String(difference.errorDecibels, 1) + " dB");
+    };
+
+    juce::AudioBuffer<float> expected, output;
+
+    for (auto controlRate : { 0.0f, 2.0f })
+    {
+        renderAutomation(expected, { topology, 0, false }, controlRate, false, automationInterval, automationInterval);
+        renderAutomation(output, { topology, 0, false }, controlRate, false, automationInterval, 64);
+        checkIdentical(controlRate > 0.0f ? "4096 vs 64 blocks smoothed" : "4096 vs 64 blocks", output, expected);
+    }
+
+    renderAutomation(expected, { topology, 1, false }, 0.0f, true, automationInterval, automationInterval);
+    renderAutomation(output, { topology, 1, false }, 0.0f, true, maximumBlockSize, automationInterval);
+    checkIdentical("blocks larger than prepared", output, expected);
+}
+
+// "Control Rate" on, the peak and high cut stepping every half second. The coefficients ramp to each step,
+// so the ramp and the samples until it has rung out aren't compared, after that the output has to match again.
+void checkControlRate(Report& report, const Session& session, double sampleRate, int layoutIndex, int topology)
+{
+    const auto stepInterval = juce::roundToInt(0.5 * sampleRate);
+    const auto settleSamples = juce::roundToInt((CoefficientSmoother::rampLengthSeconds + 0.2) * sampleRate);
+    const auto numSamples = juce::jmax(juce::roundToInt(session.seconds * sampleRate), stepInterval * 4);
+
+    auto processor = createProcessor(layouts[layoutIndex].channelSet, { topology, 0, false });
+    setParameter(*processor, "Control Rate", 2.0f); // 16 samples
+    prepare(*processor, sampleRate);
+
+    const auto numChannels = processor->getTotalNumInputChannels();
+    juce::AudioBuffer<float> buffer(numChannels, numSamples), reference(numChannels, numSamples);
+    fillSignal(buffer, SIGNAL_NOISE, sampleRate);
+    reference.makeCopyOf(buffer);
+
+    ReferenceChain referenceChain;
+    referenceChain.prepare(sampleRate, numChannels);
+
+    std::vector<char> compareMask((size_t) numSamples, 1);
+    auto lastStep = -1;
+
+    render(*processor, referenceChain, buffer, reference, [&](int position)
+    {
+        const auto stepIndex = position / stepInterval;
+
+        if (stepIndex == lastStep)
+            return;
+
+        lastStep = stepIndex;
+        const auto up = stepIndex % 2 == 1;
+
+        setParameter(*processor, "Peak Freq", up ? 3000.0f : 1000.0f);
+        setParameter(*processor, "Peak Gain", up ? -6.0f : 6.0f);
+        setParameter(*processor, "HiCut Freq", up ? 6000.0f : 12000.0f);
+
+        if (stepIndex > 0)
+            std::fill_n(compareMask.begin() + position, juce::jmin(settleSamples, numSamples - position), (char) 0);
+    });
+
+    checkDifference(report, juce::String(juce::roundToInt(sampleRate)) + " " + layouts[layoutIndex].name + " " + topologyNames[topology]
+                                + " control rate steps",
+                    compare(buffer, reference, compareMask), topology == 0, session.tolerances);
+}
+
+// Dynamic mode on the input, once with the threshold above anything the noise reaches and once well below it.
+// Above, the band pass is mixed in at exactly zero, so the output has to match the static chain. Below, the
+// reference runs its own detector on the input in the same blocks, and adds the band pass of the static chain's
+// output scaled by that modulation, which is what the engine's dynamic stage is meant to compute.
+void checkDynamicMode(Report& report, const Session& session, double sampleRate, int layoutIndex, int topology)
+{
+    const auto numSamples = juce::roundToInt(session.seconds * sampleRate);
+
+    for (auto thresholdDecibels : { 0.0f, -30.0f })
+    {
+        auto processor = createProcessor(layouts[layoutIndex].channelSet, { topology, 0, false });
+        setParameter(*processor, "Dynamic Mode", (float) _3BandEQTutorialAudioProcessor::DYNAMIC_INPUT);
+        setParameter(*processor, "Dynamic Threshold", thresholdDecibels);
+        setParameter(*processor, "Dynamic Ratio", 4.0f);
+        setParameter(*processor, "Dynamic Attack", 1.0f);
+        setParameter(*processor, "Dynamic Release", 50.0f);
+        prepare(*processor, sampleRate);
+
+        const auto numChannels = processor->getTotalNumInputChannels();
+        juce::AudioBuffer<float> buffer(numChannels, numSamples), reference(numChannels, numSamples), input(numChannels, numSamples);
+        fillSignal(buffer, SIGNAL_NOISE, sampleRate);
+        reference.makeCopyOf(buffer);
+        input.makeCopyOf(buffer);
+
+        ReferenceChain referenceChain;
+        referenceChain.prepare(sampleRate, numChannels);
+        render(*processor, referenceChain, buffer, reference);
+
+        // the detector on its own, fed exactly what processBlock feeds it
+        const auto settings = processor->getCurrentChainSettings();
+        const auto bandPass = makeBandPassCoefficients(sampleRate, settings.peakFreq, settings.peakQuality);
+        auto& parameters = processor->parameterManager;
+
+        DynamicPeak detector;
+        detector.prepare(sampleRate, maximumBlockSize);
+        detector.setDetectorBandPass(bandPass);
+        detector.setParameters(parameters.getRawParameterValue("Dynamic Threshold")->load(), parameters.getRawParameterValue("Dynamic Ratio")->load(),
+                               parameters.getRawParameterValue("Dynamic Attack")->load(), parameters.getRawParameterValue("Dynamic Release")->load());
+
+        std::vector<float> modulation((size_t) numSamples, 0.0f);
+
+        for (int start = 0, blockIndex = 0; start < numSamples; ++blockIndex)
+        {
+            const auto blockLength = juce::jmin(blockSizes[blockIndex % (int) std::size(blockSizes)], numSamples - start);
+
+            detector.process(juce::dsp::AudioBlock<float>(input).getSubBlock((size_t) start, (size_t) blockLength));
+            std::copy_n(detector.getModulation(), blockLength, modulation.begin() + start);
+            start += blockLength;
+        }
+
+        auto maxModulation = 0.0f;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            juce::dsp::IIR::Filter<float> filter(new juce::dsp::IIR::Coefficients<float>(bandPass.b0, bandPass.b1, bandPass.b2,
+                                                                                          1.0f, bandPass.a1, bandPass.a2));
+            auto* samples = reference.getWritePointer(channel);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                samples[i] += filter.processSample(samples[i]) * modulation[(size_t) i];
+                maxModulation = juce::jmax(maxModulation, std::abs(modulation[(size_t) i]));
+            }
+        }
+
+        const auto compressing = thresholdDecibels < 0.0f;
+        const auto name = juce::String(juce::roundToInt(sampleRate)) + " " + layouts[layoutIndex].name + " " + topologyNames[topology]
+                        + (compressing ? " dynamic mode compressing" : " dynamic mode idle");
+
+        // a detector that never kicks in would pass trivially, and so would one that does above the threshold
+        if (compressing != (maxModulation != 0.0f))
+        {
+            report.add(name, false, "largest modulation " + juce::String(maxModulation, 4));
+            continue;
+        }
+
+        checkDifference(report, name, compare(buffer, reference), topology == 0 && !compressing, session.tolerances);
+    }
+}
+
+// one processor re-prepared at every sample rate in turn, like a host changing its device rate
+void checkSampleRateChanges(Report& report, const Session& session, int layoutIndex, int topology)
+{
+    auto processor = createProcessor(layouts[layoutIndex].channelSet, { topology, 0, false });
+    setSlopes(*processor, { SLOPE_36, SLOPE_24 });
+
+    for (auto sampleRate : session.sampleRates)
+    {
+        prepare(*processor, sampleRate);
+
+        const auto numSamples = juce::roundToInt(session.seconds * sampleRate);
+        const auto numChannels = processor->getTotalNumInputChannels();
+        juce::AudioBuffer<float> buffer(numChannels, numSamples), reference(numChannels, numSamples);
+        fillSignal(buffer, SIGNAL_SWEEP, sampleRate);
+        reference.makeCopyOf(buffer);
+
+        ReferenceChain referenceChain;
+        referenceChain.prepare(sampleRate, numChannels);
+        render(*processor, referenceChain, buffer, reference);
+
+        checkDifference(report, "rate change to " + juce::String(juce::roundToInt(sampleRate)) + " " + layouts[layoutIndex].name + " "
+                                    + topologyNames[topology],
+                        compare(buffer, reference), topology == 0, session.tolerances);
+    }
+}
+
+// Largest second difference over [start, end) of every channel. A sine keeps it small, while a step or a kink
+// in the output, like a coefficient switch that isn't faded, stands out above it.
+float getMaxSecondDifference(const juce::AudioBuffer<float>& buffer, int start, int end)
+{
+    auto maxDifference = 0.0f;
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        auto* samples = buffer.getReadPointer(channel);
+
+        for (int i = juce::jmax(2, start); i < end; ++i)
+            maxDifference = juce::jmax(maxDifference, std::abs(samples[i] - 2.0f * samples[i - 1] + samples[i - 2]));
+    }
+
+    return maxDifference;
+}
+
+// A program change while a 1 kHz sine plays, in realtime mode, made from another thread while 64 sample blocks
+// keep coming, the way a host's message thread races its audio thread. Neither a part-written program nor
+// a designer set may get past the crossfade, so the output has to stay as smooth as either program gives it.
+void checkProgramChange(Report& report, const Session& session, double sampleRate, int layoutIndex, int topology)
+{
+    static constexpr int programBlockSize = 64, fromProgram = 0, toProgram = 5; // "Flat" to "Telephone"
+
+    const auto settleSamples = juce::roundToInt(0.1 * sampleRate);
+    const auto changeStart = juce::roundToInt(0.25 * sampleRate) / programBlockSize * programBlockSize;
+    const auto numSamples = juce::jmax(juce::roundToInt(session.seconds * sampleRate), changeStart * 4);
+
+    auto processor = createProcessor(layouts[layoutIndex].channelSet, { topology, 0, false });
+    processor->setNonRealtime(false);
+    processor->setCurrentProgram(fromProgram);
+    prepare(*processor, sampleRate);
+
+    const auto numChannels = processor->getTotalNumInputChannels();
+    juce::AudioBuffer<float> buffer(numChannels, numSamples);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int i = 0; i < numSamples; ++i)
+            buffer.setSample(channel, i, (float) (0.5 * std::sin(juce::MathConstants<double>::twoPi * 1000.0 * i / sampleRate + channel * 0.3)));
+
+    std::atomic<bool> programWritten{ false };
+    std::thread programThread;
+    auto changeEnd = numSamples;
+    juce::MidiBuffer midi;
+
+    for (int start = 0; start < numSamples; start += programBlockSize)
+    {
+        if (start == changeStart)
+            programThread = std::thread([&] { processor->setCurrentProgram(toProgram); programWritten = true; });
+
+        // paced while the program is being written, so the blocks really do overlap with it
+        if (start > changeStart && changeEnd == numSamples)
+        {
+            if (programWritten)
+                changeEnd = start;
+            else
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+
+        juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), numChannels, start, juce::jmin(programBlockSize, numSamples - start));
+        processor->processBlock(block, midi);
+    }
+
+    programThread.join();
+
+    const auto name = juce::String(juce::roundToInt(sampleRate)) + " " + layouts[layoutIndex].name + " " + topologyNames[topology] + " program change";
+
+    if (changeEnd + settleSamples * 2 > numSamples)
+    {
+        report.add(name, false, "the program took too long to write");
+        return;
+    }
+
+    // both programs on their own: before the change, and once the fade and the new program's transient are over
+    const auto steady = juce::jmax(getMaxSecondDifference(buffer, settleSamples, changeStart),
+                                   getMaxSecondDifference(buffer, numSamples - settleSamples, numSamples));
+    const auto change = getMaxSecondDifference(buffer, changeStart, numSamples);
+    const auto ratio = change / juce::jmax(steady, 1.0e-9f);
+
+    report.add(name, ratio <= 2.0f, "largest second difference " + juce::String(ratio, 2) + "x the steady state");
+}
+
+// The same program change against the reference, made offline between two blocks. Both programs have to
+// match the reference on their own, only the crossfade and the new program's settling aren't compared.
+void checkProgramCrossfade(Report& report, const Session& session, double sampleRate, int layoutIndex, int topology)
+{
+    static constexpr int fromProgram = 0, toProgram = 5; // "Flat" to "Telephone"
+
+    const auto changeAt = juce::roundToInt(0.5 * sampleRate), settleSamples = juce::roundToInt(0.25 * sampleRate);
+    const auto numSamples = juce::jmax(juce::roundToInt(session.seconds * sampleRate), changeAt * 2);
+
+    auto processor = createProcessor(layouts[layoutIndex].channelSet, { topology, 0, false });
+    processor->setCurrentProgram(fromProgram);
+    prepare(*processor, sampleRate);
+
+    const auto numChannels = processor->getTotalNumInputChannels();
+    juce::AudioBuffer<float> buffer(numChannels, numSamples), reference(numChannels, numSamples);
+    fillSignal(buffer, SIGNAL_NOISE, sampleRate);
+    reference.makeCopyOf(buffer);
+
+    ReferenceChain referenceChain;
+    referenceChain.prepare(sampleRate, numChannels);
+
+    std::vector<char> compareMask((size_t) numSamples, 1);
+    auto changed = false;
+
+    render(*processor, referenceChain, buffer, reference, [&](int position)
+    {
+        if (changed || position < changeAt)
+            return;
+
+        changed = true;
+        processor->setCurrentProgram(toProgram);
+        std::fill_n(compareMask.begin() + position, juce::jmin(settleSamples, numSamples - position), (char) 0);
+    });
+
+    checkDifference(report, juce::String(juce::roundToInt(sampleRate)) + " " + layouts[layoutIndex].name + " " + topologyNames[topology]
+                                + " program crossfade",
+                    compare(buffer, reference, compareMask), topology == 0, session.tolerances);
+}
+
+//==============================================================================
+// Worst deviation in dB between a response and the analytic one, over 20 Hz up to maxFrequency.
+// Only frequencies where the analytic response is above floorDecibels count, the stop bands are all rounding noise.
+template <typename GetMagnitude>
+double getResponseDeviation(const ChainSettings& settings, double sampleRate, int oversamplingFactor, int numPoints, double maxFrequency,
+                            double floorDecibels, GetMagnitude&& getMagnitude)
+{
+    auto deviation = 0.0;
+
+    for (int point = 0; point < numPoints; ++point)
+    {
+        const auto frequency = 20.0 * std::pow(maxFrequency / 20.0, point / (double) (numPoints - 1));
+        const auto expected = juce::Decibels::gainToDecibels(ReferenceChain::getMagnitudeForFrequency(settings, frequency, sampleRate,
+                                                                                                     oversamplingFactor), -300.0);
+
+        if (expected < floorDecibels)
+            continue;
+
+        deviation = juce::jmax(deviation, std::abs(juce::Decibels::gainToDecibels(getMagnitude(frequency), -300.0) - expected));
+    }
+
+    return deviation;
+}
+
+// the coefficients the designer comes up with, evaluated directly
+void checkDesign(Report& report, const Session& session, double sampleRate)
+{
+    for (auto oversamplingFactor : { 1, 2, 4 })
+    {
+        for (auto& slopes : slopePairs)
+        {
+            ChainSettings settings;
+            settings.lowCutFreq = 80.0f;
+            settings.peakFreq = 1000.0f;
+            settings.peakGainInDecibels = 6.0f;
+            settings.peakQuality = 1.4f;
+            settings.highCutFreq = 12000.0f;
+            settings.lowCutSlope = slopes.lowCut;
+            settings.highCutSlope = slopes.highCut;
+
+            CoefficientSet set;
+            designCoefficients(set, settings, sampleRate, ALL_BANDS, oversamplingFactor);
+
+            const auto deviation = getResponseDeviation(settings, sampleRate, oversamplingFactor, 200, juce::jmin(20000.0, 0.45 * sampleRate), -40.0,
+                                                        [&](double frequency) { return getMagnitudeForFrequency(set, frequency); });
+
+            report.add(juce::String(juce::roundToInt(sampleRate)) + " design " + juce::String(oversamplingFactor) + "x " + getSlopeName(slopes),
+                       deviation <= session.tolerances.responseDecibels, "deviation " + juce::String(deviation, 4) + " dB");
+        }
+    }
+}
+
+// the impulse response of a whole processing path, against the analytic design
+void checkMeasuredResponse(Report& report, const Session& session, double sampleRate, const EngineSettings& engine, const juce::String& name)
+{
+    const auto order = juce::jmax(12, (int) std::ceil(std::log2(sampleRate)));
+    const auto numSamples = 1 << order;
+
+    auto processor = createProcessor(juce::AudioChannelSet::mono(), engine);
+    setSlopes(*processor, { SLOPE_24, SLOPE_24 });
+    prepare(*processor, sampleRate);
+
+    juce::AudioBuffer<float> buffer(1, numSamples), reference(1, numSamples);
+    fillSignal(buffer, SIGNAL_IMPULSE, sampleRate);
+    reference.makeCopyOf(buffer);
+
+    ReferenceChain referenceChain;
+    referenceChain.prepare(sampleRate, 1);
+    render(*processor, referenceChain, buffer, reference);
+
+    std::vector<float> spectrum((size_t) numSamples * 2, 0.0f);
+    std::copy_n(buffer.getReadPointer(0), numSamples, spectrum.begin());
+    juce::dsp::FFT(order).performFrequencyOnlyForwardTransform(spectrum.data());
+
+    const auto oversamplingFactor = 1 << engine.oversampling;
+    const auto tolerance = engine.linearPhase ? session.tolerances.firResponseDecibels : session.tolerances.responseDecibels;
+
+    // the oversampler's half band filters roll off towards Nyquist, the FIR can't resolve much below a few of its bins
+    const auto maxFrequency = juce::jmin(20000.0, (oversamplingFactor > 1 ? 0.4 : 0.45) * sampleRate);
+    const auto floorDecibels = engine.linearPhase ? -20.0 : -40.0;
+    auto deviation = 0.0;
+
+    for (int bin = 1; bin < numSamples / 2; ++bin)
+    {
+        const auto frequency = bin * sampleRate / numSamples;
+
+        if (frequency < (engine.linearPhase ? 100.0 : 20.0) || frequency > maxFrequency)
+            continue;
+
+        const auto expected = juce::Decibels::gainToDecibels(ReferenceChain::getMagnitudeForFrequency(processor->getCurrentChainSettings(), frequency,
+                                                                                                     sampleRate, oversamplingFactor), -300.0);
+
+        if (expected >= floorDecibels)
+            deviation = juce::jmax(deviation, std::abs(juce::Decibels::gainToDecibels((double) spectrum[(size_t) bin], -300.0) - expected));
+    }
+
+    report.add(juce::String(juce::roundToInt(sampleRate)) + " response " + name, deviation <= tolerance,
+               "deviation " + juce::String(deviation, 4) + " dB");
+}
+
+#if EQ_NUM_USER_BANDS > 0
+// The user bands, parallel or fallen back to the cascade, against a juce::dsp::IIR cascade of the same bands
+void checkUserBands(Report& report, const Session& session, double sampleRate)
+{
+    using Coefficients = juce::dsp::IIR::Coefficients<float>;
+
+    juce::Random random(0x22 + juce::roundToInt(sampleRate));
+    const auto numSamples = juce::roundToInt(session.seconds * sampleRate);
+
+    for (int trial = 0; trial < 8; ++trial)
+    {
+        UserBandArray bands;
+
+        for (int k = 0; k < EQ_NUM_USER_BANDS; ++k)
+        {
+            auto& band = bands[(size_t) k];
+            band.type = static_cast<UserBandType>(random.nextInt(USER_BAND_HIGH_CUT + 1));
+            band.frequency = std::round(20.0f * std::pow((float) (0.45 * sampleRate / 20.0), random.nextFloat()));
+            band.gainInDecibels = std::round(random.nextFloat() * 96.0f - 48.0f) * 0.5f;
+            band.quality = 0.3f + random.nextFloat() * 4.0f;
+        }
+
+        ParallelSections sections;
+        designParallelSections(sections, bands, EQ_NUM_USER_BANDS, sampleRate);
+
+        juce::AudioBuffer<float> buffer(1, numSamples), reference(1, numSamples);
+        fillSignal(buffer, SIGNAL_NOISE, sampleRate);
+        reference.makeCopyOf(buffer);
+
+        ParallelFilterEngine engine;
+        engine.prepare({ sampleRate, (juce::uint32) numSamples, 1 });
+        engine.setSections(sections);
+        engine.process(juce::dsp::AudioBlock<float>(buffer));
+
+        auto magnitudeAt = [&](double frequency) { return getMagnitudeForFrequency(sections, frequency, sampleRate); };
+        auto deviation = 0.0;
+
+        for (auto& band : bands)
+        {
+            const auto gain = juce::Decibels::decibelsToGain(band.gainInDecibels);
+            Coefficients::Ptr coefficients;
+
+            switch (band.type)
+            {
+                case USER_BAND_PEAK:        coefficients = Coefficients::makePeakFilter(sampleRate, band.frequency, band.quality, gain); break;
+                case USER_BAND_LOW_SHELF:   coefficients = Coefficients::makeLowShelf(sampleRate, band.frequency, band.quality, gain); break;
+                case USER_BAND_HIGH_SHELF:  coefficients = Coefficients::makeHighShelf(sampleRate, band.frequency, band.quality, gain); break;
+                case USER_BAND_NOTCH:       coefficients = Coefficients::makeNotch(sampleRate, band.frequency, band.quality); break;
+                case USER_BAND_LOW_CUT:     coefficients = Coefficients::makeHighPass(sampleRate, band.frequency, band.quality); break;
+                case USER_BAND_HIGH_CUT:    coefficients = Coefficients::makeLowPass(sampleRate, band.frequency, band.quality); break;
+                case USER_BAND_OFF:
+                default:                    break;
+            }
+
+            if (coefficients == nullptr || band.isIdentity())
+                continue;
+
+            juce::dsp::IIR::Filter<float> filter(coefficients);
+            filter.prepare({ sampleRate, (juce::uint32) numSamples, 1 });
+
+            auto block = juce::dsp::AudioBlock<float>(reference);
+            filter.process(juce::dsp::ProcessContextReplacing<float>(block));
+        }
+
+        // the analytic response of the same bands, in double
+        for (int point = 0; point < 200; ++point)
+        {
+            const auto frequency = 20.0 * std::pow(juce::jmin(20000.0, 0.45 * sampleRate) / 20.0, point / 199.0);
+            auto expected = 1.0;
+
+            for (auto& band : bands)
+                if (!band.isIdentity())
+                    expected *= getMagnitudeForFrequency(makeUserBandCoefficients(band, sampleRate), frequency, sampleRate);
+
+            if (juce::Decibels::gainToDecibels(expected, -300.0) >= -40.0)
+                deviation = juce::jmax(deviation, std::abs(juce::Decibels::gainToDecibels(magnitudeAt(frequency), -300.0)
+                                                           - juce::Decibels::gainToDecibels(expected, -300.0)));
+        }
+
+        const auto name = juce::String(juce::roundToInt(sampleRate)) + " user bands " + juce::String(trial)
+                        + (sections.isParallel ? " parallel" : " cascade");
+
+        checkDifference(report, name, compare(buffer, reference), false, session.tolerances);
+        report.add(name + " response", deviation <= session.tolerances.responseDecibels, "deviation " + juce::String(deviation, 4) + " dB");
+    }
+}
+
+// One user band swept from 2 kHz to 10 kHz, a step every block, under a 200 Hz sine that two fixed bands shape.
+// Every move changes the fixed bands' share of the parallel sum too, so their state has to carry straight over
+// and the output stay as smooth as it is before and after the sweep.
+void checkUserBandAutomation(Report& report, const Session& session, double sampleRate)
+{
+    const auto settleSamples = juce::roundToInt(0.1 * sampleRate);
+    const auto numSamples = juce::jmax(juce::roundToInt(session.seconds * sampleRate), settleSamples * 8);
+    const auto sweepStart = numSamples / 4, sweepEnd = numSamples * 3 / 4;
+
+    auto processor = createProcessor(juce::AudioChannelSet::mono(), { 0, 0, false });
+
+    setParameter(*processor, "Band 1 Type", (float) USER_BAND_PEAK);
+    setParameter(*processor, "Band 1 Freq", 2000.0f);
+    setParameter(*processor, "Band 1 Gain", 9.0f);
+    setParameter(*processor, "Band 2 Type", (float) USER_BAND_LOW_SHELF);
+    setParameter(*processor, "Band 2 Freq", 150.0f);
+    setParameter(*processor, "Band 2 Gain", 6.0f);
+    setParameter(*processor, "Band 3 Type", (float) USER_BAND_PEAK);
+    setParameter(*processor, "Band 3 Freq", 400.0f);
+    setParameter(*processor, "Band 3 Gain", -4.0f);
+    setParameter(*processor, "Band 3 Q", 2.0f);
+    prepare(*processor, sampleRate);
+
+    juce::AudioBuffer<float> buffer(1, numSamples), reference(1, numSamples);
+
+    for (int i = 0; i < numSamples; ++i)
+        buffer.setSample(0, i, (float) (0.5 * std::sin(juce::MathConstants<double>::twoPi * 200.0 * i / sampleRate)));
+
+    reference.makeCopyOf(buffer);
+
+    ReferenceChain referenceChain;
+    referenceChain.prepare(sampleRate, 1);
+
+    render(*processor, referenceChain, buffer, reference, [&](int start)
+    {
+        if (start >= sweepStart && start < sweepEnd)
+            setParameter(*processor, "Band 1 Freq", (float) (2000.0 * std::pow(5.0, (start - sweepStart) / (double) (sweepEnd - sweepStart))));
+    });
+
+    const auto steady = juce::jmax(getMaxSecondDifference(buffer, settleSamples, sweepStart),
+                                   getMaxSecondDifference(buffer, numSamples - settleSamples, numSamples));
+    const auto sweep = getMaxSecondDifference(buffer, sweepStart, numSamples);
+    const auto ratio = sweep / juce::jmax(steady, 1.0e-9f);
+
+    report.add(juce::String(juce::roundToInt(sampleRate)) + " user band automation", ratio <= 2.0f,
+               "largest second difference " + juce::String(ratio, 2) + "x the steady state");
+}
+#endif
+
+#if EQ_REALTIME_SAFETY_CHECKS
+// Every engine mode rendered in realtime mode with its parameters moving on every block, while the hooks
+// linked into EQVerify watch processBlock for allocations, locks and blocking calls.
+void checkRealtimeSafety(Report& report, const Session& session, double sampleRate)
+{
+    struct Mode
+    {
+        const char* name;
+        EngineSettings engine;
+        std::function<void(_3BandEQTutorialAudioProcessor&)> setUp;
+        std::function<void(_3BandEQTutorialAudioProcessor&, int)> beforeBlock;
+    };
+
+    const auto programInterval = juce::roundToInt(0.1 * sampleRate);
+
+    const std::vector<Mode> modes
+    {
+        { "direct-form", { 0, 0, false }, {}, {} },
+        { "state-variable", { 1, 0, false }, {}, {} },
+        { "oversampling 2x", { 0, 1, false }, {}, {} },
+        { "oversampling 4x", { 0, 2, false }, {}, {} },
+        { "linear phase", { 0, 0, true }, {}, {} },
+        { "control rate", { 0, 0, false }, [](auto& processor) { setParameter(processor, "Control Rate", 2.0f); }, {} },
+        { "dynamic mode", { 0, 0, false },
+          [](auto& processor)
+          {
+              setParameter(processor, "Dynamic Mode", (float) _3BandEQTutorialAudioProcessor::DYNAMIC_INPUT);
+              setParameter(processor, "Dynamic Threshold", -30.0f);
+          }, {} },
+        { "program change", { 0, 0, false }, {},
+          [programInterval, lastChange = 0](auto& processor, int position) mutable
+          {
+              const auto changeIndex = position / programInterval;
+
+              if (changeIndex == lastChange)
+                  return;
+
+              lastChange = changeIndex;
+              processor.setCurrentProgram(changeIndex % processor.getNumPrograms());
+          } },
+       #if EQ_NUM_USER_BANDS > 0
+        { "user bands", { 0, 0, false },
+          [](auto& processor)
+          {
+              setParameter(processor, "Band 1 Type", (float) USER_BAND_PEAK);
+              setParameter(processor, "Band 1 Gain", 6.0f);
+              setParameter(processor, "Band 2 Type", (float) USER_BAND_LOW_SHELF);
+              setParameter(processor, "Band 2 Gain", -3.0f);
+          },
+          [](auto& processor, int position)
+          {
+              setParameter(processor, "Band 1 Freq", 500.0f + (float) (position % 4000));
+              setParameter(processor, "Band 2 Type", (float) (position / 20000 % 2 == 0 ? USER_BAND_LOW_SHELF : USER_BAND_NOTCH));
+          } },
+       #endif
+    };
+
+    const auto numSamples = juce::roundToInt(session.seconds * sampleRate);
+
+    for (auto& mode : modes)
+    {
+        auto processor = createProcessor(juce::AudioChannelSet::stereo(), mode.engine);
+        processor->setNonRealtime(false);
+
+        if (mode.setUp)
+            mode.setUp(*processor);
+
+        prepare(*processor, sampleRate);
+
+        juce::AudioBuffer<float> buffer(2, numSamples), reference(2, numSamples);
+        fillSignal(buffer, SIGNAL_NOISE, sampleRate);
+        reference.makeCopyOf(buffer);
+
+        ReferenceChain referenceChain;
+        referenceChain.prepare(sampleRate, 2);
+
+        const auto violationsBefore = RealtimeSafety::getNumViolations();
+
+        // modes with their own beforeBlock move their own parameters, the others sweep the bands like checkAutomation
+        render(*processor, referenceChain, buffer, reference, [&](int position)
+        {
+            if (mode.beforeBlock)
+            {
+                mode.beforeBlock(*processor, position);
+                return;
+            }
+
+            const auto ramp = (float) position / (float) numSamples;
+
+            setParameter(*processor, "Peak Freq", 200.0f * std::pow(40.0f, ramp));
+            setParameter(*processor, "Peak Gain", -12.0f + 24.0f * ramp);
+            setParameter(*processor, "HiCut Freq", (float) juce::jmin(18000.0, 0.45 * sampleRate) * std::pow(0.2f, ramp));
+        });
+
+        const auto numViolations = RealtimeSafety::getNumViolations() - violationsBefore;
+
+        report.add(juce::String(juce::roundToInt(sampleRate)) + " realtime safety " + mode.name, numViolations == 0,
+                   juce::String(numViolations) + " allocations, locks or blocking calls in processBlock");
+    }
+}
+#endif
+
+//==============================================================================
+template <typename Type>
+juce::Array<Type> parseList(const juce::String& text)
+{
+    juce::Array<Type> values;
+
+    for (auto& token : juce::StringArray::fromTokens(text, ",", {}))
+        values.add((Type) token.trim().getDoubleValue());
+
+    return values;
+}
+
+void printUsage()
+{
+    std::cout << "Usage: EQVerify [--sample-rates <n,...>] [--layouts <mono,stereo,5.1,7.1.4>] [--seconds <s>]" << std::endl
+              << "                [--ulps <n>] [--error-db <dB>] [--loose-error-db <dB>] [--response-db <dB>]" << std::endl
+              << "                [--fir-response-db <dB>] [--quiet]" << std::endl;
+}
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    Session session;
+    Report report;
+
+    juce::StringArray layoutNames;
+
+    for (auto& layout : layouts)
+        layoutNames.add(layout.name);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        juce::String argument(argv[i]);
+        auto hasValue = i + 1 < argc;
+
+        if (argument == "--sample-rates" && hasValue)
+            session.sampleRates = parseList<double>(argv[++i]);
+        else if (argument == "--layouts" && hasValue)
+        {
+            session.layoutIndices.clear();
+
+            for (auto& token : juce::StringArray::fromTokens(argv[++i], ",", {}))
+                if (layoutNames.contains(token.trim()))
+                    session.layoutIndices.add(layoutNames.indexOf(token.trim()));
+        }
+        else if (argument == "--seconds" && hasValue)
+            session.seconds = juce::jmax(0.01, juce::String(argv[++i]).getDoubleValue());
+        else if (argument == "--ulps" && hasValue)
+            session.tolerances.ulps = juce::String(argv[++i]).getLargeIntValue();
+        else if (argument == "--error-db" && hasValue)
+            session.tolerances.errorDecibels = juce::String(argv[++i]).getDoubleValue();
+        else if (argument == "--loose-error-db" && hasValue)
+            session.tolerances.looseErrorDecibels = juce::String(argv[++i]).getDoubleValue();
+        else if (argument == "--response-db" && hasValue)
+            session.tolerances.responseDecibels = juce::String(argv[++i]).getDoubleValue();
+        else if (argument == "--fir-response-db" && hasValue)
+            session.tolerances.firResponseDecibels = juce::String(argv[++i]).getDoubleValue();
+        else if (argument == "--quiet")
+            report.quiet = true;
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    for (auto sampleRate : session.sampleRates)
+    {
+        if (sampleRate <= 0)
+            continue;
+
+        checkDesign(report, session, sampleRate);
+
+        for (int topology = 0; topology < 2; ++topology)
+        {
+            for (auto layoutIndex : session.layoutIndices)
+            {
+                checkStatic(report, session, sampleRate, layoutIndex, topology);
+                checkAutomation(report, session, sampleRate, layoutIndex, topology);
+                checkSlopeSwitches(report, session, sampleRate, layoutIndex, topology);
+                checkControlRate(report, session, sampleRate, layoutIndex, topology);
+                checkBlockSizes(report, session, sampleRate, layoutIndex, topology);
+                checkDynamicMode(report, session, sampleRate, layoutIndex, topology);
+                checkProgramChange(report, session, sampleRate, layoutIndex, topology);
+                checkProgramCrossfade(report, session, sampleRate, layoutIndex, topology);
+            }
+
+            for (int oversampling = 0; oversampling < 3; ++oversampling)
+                checkMeasuredResponse(report, session, sampleRate, { topology, oversampling, false },
+                                      juce::String(topologyNames[topology]) + " " + juce::String(1 << oversampling) + "x");
+        }
+
+        checkMeasuredResponse(report, session, sampleRate, { 0, 0, true }, "linear phase");
+
+       #if EQ_NUM_USER_BANDS > 0
+        checkUserBands(report, session, sampleRate);
+        checkUserBandAutomation(report, session, sampleRate);
+       #endif
+
+       #if EQ_REALTIME_SAFETY_CHECKS
+        checkRealtimeSafety(report, session, sampleRate);
+       #endif
+    }
+
+    for (int topology = 0; topology < 2; ++topology)
+        for (auto layoutIndex : session.layoutIndices)
+            checkSampleRateChanges(report, session, layoutIndex, topology);
+
+    std::cout << report.numChecks - report.numFailures << " of " << report.numChecks << " checks passed" << std::endl;
+    return report.numFailures > 0 ? 1 : 0;
+}